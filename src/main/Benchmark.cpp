@@ -0,0 +1,204 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <utility>
+#include <main/Benchmark.h>
+#include <model/FBXReader.h>
+#include <meshstriper/StripBackend.h>
+#include <meshstriper/MeshStriper.h>
+#include <meshstriper/Sorter.h>
+#include <stripernew/Strips.h>
+#include <meshoptimizer/CacheOptimizer.h>
+#include <util/Parallel.hpp>
+#include <util/Timer.hpp>
+
+bool Benchmark::loadTriangleList(const std::string& path, const ConvertOptions& options, MeshObject* outMesh)
+{
+	ConvertOptions loadOptions = options;
+	loadOptions.buildPrimitives = false;
+	return FBXReader::readFBXModel(path.c_str(), outMesh, loadOptions);
+}
+
+void Benchmark::compareAdjacencyBuilders(const MeshObject& source, int repeats, int threadCount, std::ostream& report)
+{
+	// every builder on 1 thread, then on threadCount threads, where large meshes take the partitioned linkers
+	const AdjacencyBuilder builders[] = { AdjacencyBuilder::Sort, AdjacencyBuilder::Hash };
+	const char* names[] = { "sort", "hash" };
+	std::vector<int> threadCounts = { 1 };
+	if (threadCount > 1) threadCounts.push_back(threadCount);
+	size_t triangleCount = source.triangleList.size() / 3;
+	report << std::left << std::setw(14) << "adjacency" << std::right << std::setw(10) << "threads" << std::setw(10) << "links" << std::setw(12) << "ms" << "\n";
+	std::vector<AdjTriangle> reference;
+	for (int threads : threadCounts) {
+		const char* serialNote = threads > 1 && (int)triangleCount < MeshStriper::parallelTriangleCount ? "  serial below parallelTriangleCount" : "";
+		for (int b = 0; b < 2; b++) {
+			StripOptions stripOptions;
+			stripOptions.adjacencyBuilder = builders[b];
+			stripOptions.threadCount = threads;
+			MeshStriper linker;
+			linker.setOptions(stripOptions);
+			std::vector<AdjTriangle> adjacencies;
+			double bestMilliseconds = -1.0;
+			for (int run = 0; run < repeats; run++) {
+				auto start = Timer::begin();
+				linker.createAdjacencies(source.triangleList, adjacencies);
+				double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+				if (bestMilliseconds < 0.0 || milliseconds < bestMilliseconds) bestMilliseconds = milliseconds;
+			}
+			size_t linkCount = 0;
+			bool matches = true;
+			for (size_t t = 0; t < adjacencies.size(); t++) {
+				for (int k = 0; k < 3; k++) {
+					linkCount += adjacencies[t].adjacentTris[k] != -1;
+					if (!reference.empty()) matches &= adjacencies[t].adjacentTris[k] == reference[t].adjacentTris[k];
+				}
+			}
+			if (reference.empty()) reference.swap(adjacencies);
+			report << std::left << std::setw(14) << names[b] << std::right << std::setw(10) << threads << std::setw(10) << linkCount << std::setw(12) << bestMilliseconds
+				<< (matches ? "" : "  links differ from sort on 1 thread") << serialNote << "\n";
+		}
+	}
+
+	// the Striper links its faces with its own builder, which is compared against itself on 1 thread
+	std::vector<uint32_t> striperReference;
+	for (int threads : threadCounts) {
+		std::vector<uint32_t> links;
+		double bestMilliseconds = -1.0;
+		bool linked = true;
+		for (int run = 0; run < repeats && linked; run++) {
+			auto start = Timer::begin();
+			linked = StriperBackend::linkFaces(source.triangleList, threads, links);
+			double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			if (bestMilliseconds < 0.0 || milliseconds < bestMilliseconds) bestMilliseconds = milliseconds;
+		}
+		report << std::left << std::setw(14) << "striper" << std::right << std::setw(10) << threads;
+		if (!linked) {
+			report << "  non-manifold\n";
+			break;
+		}
+		size_t linkCount = links.size() - std::count(links.begin(), links.end(), 0xFFFFFFFF);
+		bool matches = striperReference.empty() || links == striperReference;
+		if (striperReference.empty()) striperReference.swap(links);
+		report << std::setw(10) << linkCount << std::setw(12) << bestMilliseconds << (matches ? "" : "  links differ from striper on 1 thread") << "\n";
+	}
+}
+
+void Benchmark::compareSorters(const MeshObject& source, int repeats, int threadCount, std::ostream& report)
+{
+	size_t edgeCount = source.triangleList.size();
+	std::vector<uint16_t> firstVertices(edgeCount);
+	std::vector<uint16_t> secondVertices(edgeCount);
+	for (size_t t = 0; t + 2 < edgeCount; t += 3) {
+		for (int k = 0; k < 3; k++) {
+			uint16_t v0 = (uint16_t)source.triangleList[t + k];
+			uint16_t v1 = (uint16_t)source.triangleList[t + (k + 1) % 3];
+			firstVertices[t + k] = std::min(v0, v1);
+			secondVertices[t + k] = std::max(v0, v1);
+		}
+	}
+	// serial sorts once, parallel sorts at 2, 4, 8... threads up to threadCount
+	const char* names[] = { "sortFast", "sortRadix", "sortBytes", "sortFastPar", "sortBytesPar" };
+	std::vector<std::pair<int, int>> runs = { { 0, 1 }, { 1, 1 }, { 2, 1 } };
+	for (int threads = 2; threads < threadCount * 2; threads *= 2) {
+		runs.push_back({ 3, std::min(threads, threadCount) });
+		runs.push_back({ 4, std::min(threads, threadCount) });
+	}
+	report << std::left << std::setw(14) << "sort" << std::right << std::setw(10) << "threads" << std::setw(10) << "edges" << std::setw(12) << "ms" << "\n";
+	if (edgeCount == 0) return;
+	std::vector<int> reference;
+	for (const std::pair<int, int>& run : runs) {
+		int method = run.first;
+		int threads = run.second;
+		Sorter sorter;
+		std::vector<int> firstSorted(edgeCount);
+		std::vector<int> secondSorted(edgeCount);
+		double bestMilliseconds = -1.0;
+		for (int repeat = 0; repeat < repeats; repeat++) {
+			auto start = Timer::begin();
+			if (method == 0) {
+				sorter.sortFast(firstVertices, firstSorted);
+				sorter.sortFast(secondVertices, firstSorted, secondSorted);
+			}
+			else if (method == 1) {
+				sorter.sortRadix(firstVertices, firstSorted);
+				sorter.sortRadix(secondVertices, firstSorted, secondSorted);
+			}
+			else if (method == 2) {
+				sorter.sortBytes(firstVertices, firstSorted);
+				sorter.sortBytes(secondVertices, firstSorted, secondSorted);
+			}
+			else if (method == 3) {
+				sorter.sortFastParallel(firstVertices, firstSorted, threads);
+				sorter.sortFastParallel(secondVertices, firstSorted, secondSorted, threads);
+			}
+			else {
+				sorter.sortBytesParallel(firstVertices, firstSorted, threads);
+				sorter.sortBytesParallel(secondVertices, firstSorted, secondSorted, threads);
+			}
+			double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			if (bestMilliseconds < 0.0 || milliseconds < bestMilliseconds) bestMilliseconds = milliseconds;
+		}
+		if (method == 0) reference = secondSorted;
+		report << std::left << std::setw(14) << names[method] << std::right << std::setw(10) << threads << std::setw(10) << edgeCount << std::setw(12) << bestMilliseconds
+			<< (secondSorted == reference ? "" : "  order differs from sortFast") << "\n";
+	}
+}
+
+void Benchmark::compareStripBackends(const std::vector<std::string>& paths, const ConvertOptions& options, int repeats)
+{
+	StripOptions stripOptions;
+	stripOptions.threadCount = Parallel::threadCount(options.threadCount);
+	stripOptions.leastConnectedFirst = options.leastConnectedFirst;
+	stripOptions.speculativeStarts = options.speculativeStarts;
+	stripOptions.tunnelSeconds = options.tunnelSeconds;
+	stripOptions.adjacencyBuilder = options.adjacencyBuilder;
+	if (options.cacheAwareStrips) stripOptions.cacheSize = options.cacheSize;
+	for (const std::string& path : paths) {
+		MeshObject source;
+		if (!loadTriangleList(path, options, &source)) {
+			std::cout << "[BENCHMARK] Couldn't read '" << path << "'" << std::endl;
+			continue;
+		}
+		size_t triangleCount = source.triangleList.size() / 3;
+
+		std::ostringstream report;
+		report << std::fixed << std::setprecision(3);
+		report << "[BENCHMARK] " << path << ": " << triangleCount << " triangles, " << source.vertices.size() << " vertices\n";
+		report << std::left << std::setw(14) << "backend" << std::right << std::setw(10) << "strips" << std::setw(12) << "indices"
+			<< std::setw(14) << "indices/tri" << std::setw(10) << "acmr" << std::setw(12) << "ms" << "\n";
+		for (StripBackendType type : StripBackend::allTypes) {
+			std::unique_ptr<StripBackend> backend = StripBackend::create(type, stripOptions);
+			double bestMilliseconds = -1.0;
+			size_t stripCount = 0;
+			size_t indexCount = 0;
+			float acmr = 0.0f;
+			bool success = true;
+			for (int run = 0; run < repeats && success; run++) {
+				MeshObject mesh;
+				mesh.vertices = source.vertices;
+				mesh.triangleList = source.triangleList;
+				auto start = Timer::begin();
+				success = backend->striper(&mesh);
+				double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+				if (bestMilliseconds < 0.0 || milliseconds < bestMilliseconds) bestMilliseconds = milliseconds;
+				stripCount = mesh.triangleStrips.size();
+				indexCount = 0;
+				for (const std::vector<uint16_t>& strip : mesh.triangleStrips) indexCount += strip.size();
+				acmr = CacheOptimizer::computeStripACMR(mesh.triangleStrips, mesh.vertices.size(), options.cacheSize);
+			}
+			report << std::left << std::setw(14) << backend->getName() << std::right;
+			if (!success) {
+				report << "  failed\n";
+				continue;
+			}
+			report << std::setw(10) << stripCount << std::setw(12) << indexCount
+				<< std::setw(14) << (triangleCount ? (double)indexCount / (double)triangleCount : 0.0) << std::setw(10) << acmr << std::setw(12) << bestMilliseconds << "\n";
+		}
+		compareAdjacencyBuilders(source, repeats, stripOptions.threadCount, report);
+		compareSorters(source, repeats, stripOptions.threadCount, report);
+		std::cout << report.str() << std::flush;
+	}
+}
\ No newline at end of file
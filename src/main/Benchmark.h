@@ -0,0 +1,54 @@
+#ifndef SRC_MAIN_BENCHMARK_H_
+#define SRC_MAIN_BENCHMARK_H_
+
+#include <string>
+#include <ostream>
+#include <vector>
+#include <model/MeshObject.h>
+#include <model/ConvertOptions.h>
+
+class Benchmark {
+private:
+	/// <summary>
+	/// Read an fbx file and run the conversion up to, but not including, striping.
+	/// </summary>
+	/// <param name="path">- fbx file to read</param>
+	/// <param name="options">- conversion settings</param>
+	/// <param name="outMesh">- mesh with a triangle list</param>
+	/// <returns>Read success</returns>
+	static bool loadTriangleList(const std::string& path, const ConvertOptions& options, MeshObject* outMesh);
+
+	/// <summary>
+	/// <para/>Time MeshStriper::createAdjacencies with every AdjacencyBuilder, and the Striper's own linker, on 1 thread and on threadCount threads.
+	/// <para/>Every MeshStriper run is checked against the single threaded sort, and every Striper run against the Striper on 1 thread,
+	/// so the partitioned linkers of large meshes are checked against the serial ones.
+	/// </summary>
+	/// <param name="source">- mesh with a triangle list</param>
+	/// <param name="repeats">- runs per builder</param>
+	/// <param name="threadCount">- threads for the parallel runs, 1 to only time the serial linkers</param>
+	/// <param name="report">- stream to print the results to</param>
+	static void compareAdjacencyBuilders(const MeshObject& source, int repeats, int threadCount, std::ostream& report);
+
+	/// <summary>
+	/// <para/>Time the Sorter methods on the edges of the mesh, sorting by first then second vertex the way MeshStriper links
+	/// triangles, and check that they all give the order sortFast gives.
+	/// <para/>The parallel sorts are timed at 2, 4, 8... threads, up to threadCount, to show how they scale.
+	/// </summary>
+	/// <param name="source">- mesh with a triangle list</param>
+	/// <param name="repeats">- runs per sort</param>
+	/// <param name="threadCount">- most threads the parallel sorts are timed with</param>
+	/// <param name="report">- stream to print the results to</param>
+	static void compareSorters(const MeshObject& source, int repeats, int threadCount, std::ostream& report);
+public:
+	/// <summary>
+	/// <para/>Stripe every file with every strip backend, and print the strip count, index count, ACMR and runtime of each.
+	/// <para/>Each backend stripes a fresh copy of the same triangle list, and the fastest of the repeats is reported.
+	/// <para/>The adjacency builders and the sorts are compared the same way.
+	/// </summary>
+	/// <param name="paths">- fbx files to benchmark</param>
+	/// <param name="options">- conversion settings used to prepare the triangle lists, and the thread count given to the backends</param>
+	/// <param name="repeats">- runs per backend and file</param>
+	static void compareStripBackends(const std::vector<std::string>& paths, const ConvertOptions& options, int repeats = 3);
+};
+
+#endif
\ No newline at end of file
@@ -1,12 +1,121 @@
 #include <iostream>
+#include <string>
+#include <stdexcept>
 #include <model/MeshObject.h>
+#include <model/ConvertOptions.h>
 #include <model/FBXReader.h>
 #include <model/ModelManager.h>
+#include <main/Benchmark.h>
 #include <util/Timer.hpp>
 
+static const char* syntax =
+	"syntax: modelmaker <inputfile.fbx> <outputfile.whateverextension> [options]\n"
+	"        modelmaker --benchmark <inputfile.fbx> [more inputfiles] [options]\n"
+	"options:\n"
+	"  --trilist           store a vertex cache optimized triangle list instead of triangle strips\n"
+	"  --cache-size <n>    vertex cache size used to optimize and measure triangle lists and strips (default 32)\n"
+	"  --no-reorder        keep the fbx vertex order instead of renumbering vertices by first use\n"
+	"  --no-weld           keep duplicate vertices and uv coords\n"
+	"  --weld-epsilon <e>  distance below which vertices are merged (default 0.0001)\n"
+	"  --separate-uvs      keep uv indexes separate instead of splitting vertices along uv seams and hard edges\n"
+	"  --simplify <r|n>    simplify to a fraction (0-1) or a number of triangles\n"
+	"  --simplify-error <e> stop simplifying before the surface moves further than e\n"
+	"  --no-spatial-order  keep the fbx triangle order instead of sorting triangles along a Morton curve before striping\n"
+	"  --striper <name>    strip backend: meshstriper (default), striper or treestriper\n"
+	"  --index-order       start strips in triangle index order instead of at the least connected triangle\n"
+	"  --speculate <k>     striper: track the strips of the next k start triangles at once on --threads threads\n"
+	"  --cache-strips      grow meshstriper strips for the vertex cache instead of only for length\n"
+	"  --adjacency <name>  how shared edges are found: auto (default), sort or hash\n"
+	"  --tunnel <seconds>  join meshstriper strips by tunneling for up to this long\n"
+	"  --previous <file.m> keep the strips of an earlier conversion where the triangles didn't change, restripe the rest\n"
+	"  --stitch <mode>     join the strips into one: auto (default), degenerate, restart or none\n"
+	"  --draw-call-cost <n> cost of a draw call in indices, used by --stitch auto (default 512)\n"
+	"  --threads <n>       threads used by the parallel stages (default: one per hardware thread)\n";
+
+/// <summary>
+/// Read the options that follow the input and output files
+/// </summary>
+/// <param name="argc"></param>
+/// <param name="argv"></param>
+/// <param name="first">- index of the first option in argv</param>
+/// <param name="options">- options to fill in</param>
+/// <returns>False if an option wasn't recognised or its value isn't valid</returns>
+static bool parseOptions(int argc, char* argv[], int first, ConvertOptions& options)
+{
+	for (int i = first; i < argc; i++) {
+		std::string arg(argv[i]);
+		try {
+			if (arg == "--trilist") options.primitiveType = MeshObject::PrimitiveType::TriangleList;
+			else if (arg == "--cache-size" && i + 1 < argc) options.cacheSize = std::stoi(argv[++i]);
+			else if (arg == "--no-reorder") options.reorderVertices = false;
+			else if (arg == "--no-weld") options.weld = false;
+			else if (arg == "--weld-epsilon" && i + 1 < argc) options.weldEpsilon = std::stof(argv[++i]);
+			else if (arg == "--separate-uvs") options.splitVertices = false;
+			else if (arg == "--simplify" && i + 1 < argc) {
+				double value = std::stod(argv[++i]);
+				if (value <= 1.0) options.simplifyRatio = (float)value;
+				else options.simplifyTriangleCount = (size_t)value;
+			}
+			else if (arg == "--simplify-error" && i + 1 < argc) options.simplifyError = std::stof(argv[++i]);
+			else if (arg == "--no-spatial-order") options.spatialOrder = false;
+			else if (arg == "--striper" && i + 1 < argc) {
+				if (!StripBackend::parseType(argv[++i], options.stripBackend)) {
+					std::cout << "unknown striper '" << argv[i] << "'" << std::endl;
+					return false;
+				}
+			}
+			else if (arg == "--index-order") options.leastConnectedFirst = false;
+			else if (arg == "--speculate" && i + 1 < argc) {
+				options.speculativeStarts = std::stoi(argv[++i]);
+				if (options.speculativeStarts < 0) {
+					std::cout << "--speculate needs 0 or more start triangles" << std::endl;
+					return false;
+				}
+				if (options.speculativeStarts > StripOptions::maxSpeculativeStarts) options.speculativeStarts = StripOptions::maxSpeculativeStarts;
+			}
+			else if (arg == "--cache-strips") options.cacheAwareStrips = true;
+			else if (arg == "--adjacency" && i + 1 < argc) {
+				std::string builder(argv[++i]);
+				if (builder == "auto") options.adjacencyBuilder = AdjacencyBuilder::Auto;
+				else if (builder == "sort") options.adjacencyBuilder = AdjacencyBuilder::Sort;
+				else if (builder == "hash") options.adjacencyBuilder = AdjacencyBuilder::Hash;
+				else {
+					std::cout << "unknown adjacency builder '" << builder << "'" << std::endl;
+					return false;
+				}
+			}
+			else if (arg == "--tunnel" && i + 1 < argc) options.tunnelSeconds = std::stof(argv[++i]);
+			else if (arg == "--previous" && i + 1 < argc) options.previousModel = argv[++i];
+			else if (arg == "--stitch" && i + 1 < argc) {
+				std::string mode(argv[++i]);
+				if (mode == "auto") options.stitchMode = StitchMode::Auto;
+				else if (mode == "degenerate") options.stitchMode = StitchMode::Degenerate;
+				else if (mode == "restart") options.stitchMode = StitchMode::Restart;
+				else if (mode == "none") options.stitchMode = StitchMode::None;
+				else {
+					std::cout << "unknown stitch mode '" << mode << "'" << std::endl;
+					return false;
+				}
+			}
+			else if (arg == "--draw-call-cost" && i + 1 < argc) options.drawCallCost = std::stoi(argv[++i]);
+			else if (arg == "--threads" && i + 1 < argc) options.threadCount = std::stoi(argv[++i]);
+			else {
+				std::cout << "unknown option '" << arg << "'" << std::endl;
+				return false;
+			}
+		}
+		catch (const std::logic_error&) {
+			// std::stoi and std::stof throw invalid_argument or out_of_range for a malformed number
+			std::cout << "invalid number '" << argv[i] << "' for option '" << arg << "'" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
 /// <summary>
 /// Command line syntax:
-/// modelmaker &lt;input.fbx&gt; &lt;output.whateverextension&gt;
+/// modelmaker &lt;input.fbx&gt; &lt;output.whateverextension&gt; [options]
 /// </summary>
 /// <param name="argc"></param>
 /// <param name="argv"></param>
@@ -26,12 +135,29 @@ int main(int argc, char* argv[])
 
 	Timer::end(start, "Program completed in: ");
 #else
-	if (argc == 1) {
-		std::cout << "syntax: modelmaker <inputfile.fbx> <outputfile.whateverextension>";
+	if (argc >= 2 && std::string(argv[1]) == "--benchmark") {
+		std::vector<std::string> paths;
+		int first = 2;
+		while (first < argc && std::string(argv[first]).compare(0, 2, "--") != 0) paths.push_back(argv[first++]);
+		ConvertOptions options;
+		if (paths.empty() || !parseOptions(argc, argv, first, options)) {
+			std::cout << syntax;
+			return 1;
+		}
+		Benchmark::compareStripBackends(paths, options);
 		return 0;
 	}
+	if (argc < 3) {
+		std::cout << syntax;
+		return 0;
+	}
+	ConvertOptions options;
+	if (!parseOptions(argc, argv, 3, options)) {
+		std::cout << syntax;
+		return 1;
+	}
 	MeshObject fbxMesh;
-	if (FBXReader::readFBXModel(argv[1], &fbxMesh)) {
+	if (FBXReader::readFBXModel(argv[1], &fbxMesh, options)) {
 		ModelManager::writeToDisk(&fbxMesh, argv[2]);
 		MeshObject readMesh;
 		ModelManager::readModel(argv[2], &readMesh);
@@ -0,0 +1,242 @@
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <algorithm>
+#include <meshoptimizer/CacheOptimizer.h>
+#include <util/Timer.hpp>
+
+// Scoring constants from Forsyth's "Linear-Speed Vertex Cache Optimisation"
+static const float cacheDecayPower = 1.5f;
+static const float lastTriangleScore = 0.75f;
+static const float valenceBoostScale = 2.0f;
+static const float valenceBoostPower = 0.5f;
+static const int maxValenceScore = 32;
+
+struct ForsythScoreTable {
+	float cache[CacheOptimizer::maxCacheSize + 3];
+	float valence[maxValenceScore];
+
+	ForsythScoreTable(int cacheSize) {
+		for (int i = 0; i < cacheSize + 3; i++) {
+			if (i < 3) cache[i] = lastTriangleScore; // the vertices of the last triangle get a fixed score
+			else if (i < cacheSize) cache[i] = powf(1.0f - (float)(i - 3) / (float)(cacheSize - 3), cacheDecayPower);
+			else cache[i] = 0.0f;
+		}
+		valence[0] = 0.0f;
+		for (int i = 1; i < maxValenceScore; i++) {
+			valence[i] = valenceBoostScale * powf((float)i, -valenceBoostPower);
+		}
+	}
+
+	float score(int cachePosition, uint32_t remainingTriangles, int cacheSize) const {
+		if (remainingTriangles == 0) return -1.0f; // nothing left to draw with this vertex
+		float result = cachePosition >= 0 && cachePosition < cacheSize ? cache[cachePosition] : 0.0f;
+		if (remainingTriangles < maxValenceScore) result += valence[remainingTriangles];
+		else result += valenceBoostScale * powf((float)remainingTriangles, -valenceBoostPower);
+		return result;
+	}
+};
+
+void CacheOptimizer::optimizeForsyth(std::vector<uint32_t>& indices, size_t vertexCount, int cacheSize)
+{
+#if _DEBUG
+	auto start = Timer::begin();
+#endif
+	cacheSize = std::max(4, std::min(cacheSize, (int)maxCacheSize));
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) return;
+	ForsythScoreTable table(cacheSize);
+	const uint32_t* indicesPtr = indices.data();
+
+	// vertex -> triangle lists, stored contiguously. Triangles that have been drawn are swapped to the end of each list.
+	std::vector<uint32_t> remaining(vertexCount);
+	std::vector<uint32_t> offsets(vertexCount + 1);
+	uint32_t* remainingPtr = remaining.data();
+	for (size_t i = 0; i < triangleCount * 3; i++) {
+		remainingPtr[indicesPtr[i]]++;
+	}
+	uint32_t* offsetsPtr = offsets.data();
+	for (size_t v = 0; v < vertexCount; v++) {
+		offsetsPtr[v + 1] = offsetsPtr[v] + remainingPtr[v];
+	}
+	std::vector<uint32_t> vertexTriangles(triangleCount * 3);
+	uint32_t* vertexTrianglesPtr = vertexTriangles.data();
+	{
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; i++) {
+			vertexTrianglesPtr[fill[indicesPtr[i]]++] = (uint32_t)(i / 3);
+		}
+	}
+
+	std::vector<int> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	std::vector<float> triangleScores(triangleCount, 0.0f);
+	std::vector<char> triangleAdded(triangleCount, 0);
+	int* cachePositionsPtr = cachePositions.data();
+	float* vertexScoresPtr = vertexScores.data();
+	float* triangleScoresPtr = triangleScores.data();
+	for (size_t v = 0; v < vertexCount; v++) {
+		vertexScoresPtr[v] = table.score(-1, remainingPtr[v], cacheSize);
+	}
+	for (size_t t = 0; t < triangleCount; t++) {
+		const uint32_t* tri = &indicesPtr[t * 3];
+		triangleScoresPtr[t] = vertexScoresPtr[tri[0]] + vertexScoresPtr[tri[1]] + vertexScoresPtr[tri[2]];
+	}
+
+	// Cache holds cacheSize entries, plus room for the 3 vertices of the triangle being added
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> newCache;
+	cache.reserve(cacheSize + 3);
+	newCache.reserve(cacheSize + 3);
+
+	std::vector<uint32_t> output(triangleCount * 3);
+	uint32_t* outputPtr = output.data();
+	size_t nextUnaddedTriangle = 0;
+	int64_t bestTriangle = -1;
+
+	for (size_t drawn = 0; drawn < triangleCount; drawn++) {
+		if (bestTriangle < 0) {
+			// Nothing touches the cache, start again from the first triangle not drawn yet
+			while (triangleAdded[nextUnaddedTriangle]) nextUnaddedTriangle++;
+			bestTriangle = (int64_t)nextUnaddedTriangle;
+		}
+		uint32_t triangle = (uint32_t)bestTriangle;
+		const uint32_t* tri = &indicesPtr[triangle * 3];
+		memcpy(&outputPtr[drawn * 3], tri, 3 * sizeof(uint32_t));
+		triangleAdded[triangle] = 1;
+
+		// Move the triangle to the end of the active part of each vertex's list
+		for (int k = 0; k < 3; k++) {
+			uint32_t v = tri[k];
+			uint32_t* list = &vertexTrianglesPtr[offsetsPtr[v]];
+			uint32_t count = remainingPtr[v];
+			for (uint32_t i = 0; i < count; i++) {
+				if (list[i] == triangle) {
+					list[i] = list[count - 1];
+					list[count - 1] = triangle;
+					break;
+				}
+			}
+			remainingPtr[v]--;
+		}
+
+		// New cache: the triangle's vertices at the front, followed by the old cache without them
+		newCache.clear();
+		newCache.push_back(tri[0]);
+		newCache.push_back(tri[1]);
+		newCache.push_back(tri[2]);
+		for (uint32_t v : cache) {
+			if (v != tri[0] && v != tri[1] && v != tri[2]) newCache.push_back(v);
+		}
+		for (size_t i = cacheSize; i < newCache.size(); i++) {
+			cachePositionsPtr[newCache[i]] = -1; // pushed out of the cache
+		}
+
+		// Rescore every vertex that was or is in the cache, and the triangles that still use them
+		for (size_t i = 0; i < newCache.size(); i++) {
+			uint32_t v = newCache[i];
+			int position = i < (size_t)cacheSize ? (int)i : -1;
+			cachePositionsPtr[v] = position;
+			float newScore = table.score(position, remainingPtr[v], cacheSize);
+			float delta = newScore - vertexScoresPtr[v];
+			vertexScoresPtr[v] = newScore;
+			const uint32_t* list = &vertexTrianglesPtr[offsetsPtr[v]];
+			for (uint32_t j = 0; j < remainingPtr[v]; j++) {
+				triangleScoresPtr[list[j]] += delta;
+			}
+		}
+
+		// Pick the best triangle among those touching the cache
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		size_t cacheEntries = std::min(newCache.size(), (size_t)cacheSize);
+		for (size_t i = 0; i < cacheEntries; i++) {
+			uint32_t v = newCache[i];
+			const uint32_t* list = &vertexTrianglesPtr[offsetsPtr[v]];
+			for (uint32_t j = 0; j < remainingPtr[v]; j++) {
+				if (triangleScoresPtr[list[j]] > bestScore) {
+					bestScore = triangleScoresPtr[list[j]];
+					bestTriangle = list[j];
+				}
+			}
+		}
+
+		newCache.resize(cacheEntries);
+		cache.swap(newCache);
+	}
+
+	indices.swap(output);
+#if _DEBUG
+	Timer::end(start, "Optimized (" + std::to_string(triangleCount) + ") triangles for vertex cache: ");
+#endif
+}
+
+size_t CacheOptimizer::simulateFIFO(const uint32_t* indices, size_t indexCount, size_t vertexCount, int cacheSize)
+{
+	// A vertex is in the cache if fewer than cacheSize misses happened since it was loaded
+	std::vector<size_t> loadedAt(vertexCount, 0);
+	size_t* loadedAtPtr = loadedAt.data();
+	size_t misses = 0;
+	size_t clock = (size_t)cacheSize + 1;
+	for (size_t i = 0; i < indexCount; i++) {
+		uint32_t v = indices[i];
+		if (clock - loadedAtPtr[v] > (size_t)cacheSize) {
+			loadedAtPtr[v] = clock++;
+			misses++;
+		}
+	}
+	return misses;
+}
+
+size_t CacheOptimizer::simulateStripFIFO(const std::vector<std::vector<uint16_t>>& strips, size_t vertexCount, int cacheSize)
+{
+	std::vector<size_t> loadedAt(vertexCount, 0);
+	size_t* loadedAtPtr = loadedAt.data();
+	size_t misses = 0;
+	size_t clock = (size_t)cacheSize + 1;
+	for (const std::vector<uint16_t>& strip : strips) {
+		for (uint16_t v : strip) {
+			if (clock - loadedAtPtr[v] > (size_t)cacheSize) {
+				loadedAtPtr[v] = clock++;
+				misses++;
+			}
+		}
+	}
+	return misses;
+}
+
+float CacheOptimizer::computeStripACMR(const std::vector<std::vector<uint16_t>>& strips, size_t vertexCount, int cacheSize)
+{
+	size_t triangleCount = 0;
+	for (const std::vector<uint16_t>& strip : strips) {
+		for (size_t i = 2; i < strip.size(); i++) {
+			if (strip[i] != strip[i - 1] && strip[i] != strip[i - 2] && strip[i - 1] != strip[i - 2]) triangleCount++;
+		}
+	}
+	if (triangleCount == 0) return 0.0f;
+	size_t misses = simulateStripFIFO(strips, vertexCount, cacheSize);
+	return (float)misses / (float)triangleCount;
+}
+
+float CacheOptimizer::computeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, int cacheSize)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) return 0.0f;
+	size_t misses = simulateFIFO(indices.data(), indices.size(), vertexCount, cacheSize);
+	return (float)misses / (float)triangleCount;
+}
+
+float CacheOptimizer::computeATVR(const std::vector<uint32_t>& indices, size_t vertexCount, int cacheSize)
+{
+	std::vector<char> used(vertexCount, 0);
+	size_t usedCount = 0;
+	for (uint32_t v : indices) {
+		if (!used[v]) {
+			used[v] = 1;
+			usedCount++;
+		}
+	}
+	if (usedCount == 0) return 0.0f;
+	size_t misses = simulateFIFO(indices.data(), indices.size(), vertexCount, cacheSize);
+	return (float)misses / (float)usedCount;
+}
\ No newline at end of file
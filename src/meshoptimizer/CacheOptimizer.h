@@ -0,0 +1,73 @@
+#ifndef SRC_MESHOPTIMIZER_CACHEOPTIMIZER_H_
+#define SRC_MESHOPTIMIZER_CACHEOPTIMIZER_H_
+
+#include <vector>
+#include <cstdint>
+
+class CacheOptimizer {
+public:
+	static const int maxCacheSize = 64;
+
+	/// <summary>
+	/// <para/>Reorder the triangles of an indexed triangle list for the post-transform vertex cache, using Tom Forsyth's
+	/// linear-speed vertex cache optimisation.
+	/// <para/>Each vertex gets a score from its position in a simulated LRU cache and from how many triangles still use it.
+	/// The triangle with the highest score among the triangles touching the cache is emitted next, so only the triangles
+	/// around the cached vertices are rescored after each step.
+	/// </summary>
+	/// <param name="indices">- triangle list, 3 indices per triangle. Reordered in place.</param>
+	/// <param name="vertexCount">- number of vertices the indices refer to</param>
+	/// <param name="cacheSize">- simulated cache size, clamped to maxCacheSize</param>
+	static void optimizeForsyth(std::vector<uint32_t>& indices, size_t vertexCount, int cacheSize = 32);
+
+	/// <summary>
+	/// <para/>Average cache miss ratio: vertices transformed per triangle, simulating a FIFO cache of the given size.
+	/// <para/>0.5 is the best possible on a large regular mesh, 3.0 the worst.
+	/// </summary>
+	/// <param name="indices">- triangle list, 3 indices per triangle</param>
+	/// <param name="vertexCount">- number of vertices the indices refer to</param>
+	/// <param name="cacheSize">- simulated cache size</param>
+	/// <returns>ACMR</returns>
+	static float computeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, int cacheSize = 32);
+
+	/// <summary>
+	/// <para/>Average transform to vertex ratio: vertices transformed per vertex used by the mesh, simulating a FIFO cache of the given size.
+	/// <para/>1.0 means every vertex is transformed exactly once.
+	/// </summary>
+	/// <param name="indices">- triangle list, 3 indices per triangle</param>
+	/// <param name="vertexCount">- number of vertices the indices refer to</param>
+	/// <param name="cacheSize">- simulated cache size</param>
+	/// <returns>ATVR</returns>
+	static float computeATVR(const std::vector<uint32_t>& indices, size_t vertexCount, int cacheSize = 32);
+
+	/// <summary>
+	/// Number of vertices transformed when drawing the indices in order through a FIFO cache of the given size.
+	/// </summary>
+	/// <param name="indices">- indices in draw order</param>
+	/// <param name="indexCount">- number of indices</param>
+	/// <param name="vertexCount">- number of vertices the indices refer to</param>
+	/// <param name="cacheSize">- simulated cache size</param>
+	/// <returns>Number of cache misses</returns>
+	static size_t simulateFIFO(const uint32_t* indices, size_t indexCount, size_t vertexCount, int cacheSize);
+
+	/// <summary>
+	/// <para/>Number of vertices transformed when drawing the strips one after another through a FIFO cache of the given size.
+	/// <para/>The cache isn't flushed between strips, as if they were stitched into a single draw call.
+	/// </summary>
+	/// <param name="strips">- triangle strips in draw order</param>
+	/// <param name="vertexCount">- number of vertices the strips refer to</param>
+	/// <param name="cacheSize">- simulated cache size</param>
+	/// <returns>Number of cache misses</returns>
+	static size_t simulateStripFIFO(const std::vector<std::vector<uint16_t>>& strips, size_t vertexCount, int cacheSize);
+
+	/// <summary>
+	/// Average cache miss ratio of triangle strips, see computeACMR and simulateStripFIFO. Degenerate triangles aren't counted.
+	/// </summary>
+	/// <param name="strips">- triangle strips in draw order</param>
+	/// <param name="vertexCount">- number of vertices the strips refer to</param>
+	/// <param name="cacheSize">- simulated cache size</param>
+	/// <returns>ACMR</returns>
+	static float computeStripACMR(const std::vector<std::vector<uint16_t>>& strips, size_t vertexCount, int cacheSize = 32);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,489 @@
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <queue>
+#include <algorithm>
+#include <meshoptimizer/Simplifier.h>
+#include <util/Parallel.hpp>
+#include <util/Timer.hpp>
+
+// Boundary edges get a plane perpendicular to their triangle, weighted this much more than the triangle planes
+static const double boundaryWeight = 10.0;
+// Collapses may not leave a vertex with more triangles than this, unless it already had more
+static const size_t maxVertexTriangles = 16;
+// Squared edge length added to every collapse error, to break ties between collapses that don't change the surface
+static const double edgeLengthWeight = 1e-6;
+
+struct Quadric {
+	// symmetric 4x4 matrix, upper triangle, and the total weight of the planes added
+	double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+	double b0 = 0, b1 = 0, b2 = 0;
+	double c = 0;
+	double weight = 0;
+
+	void addPlane(double nx, double ny, double nz, double d, double w) {
+		a00 += w * nx * nx; a01 += w * nx * ny; a02 += w * nx * nz;
+		a11 += w * ny * ny; a12 += w * ny * nz; a22 += w * nz * nz;
+		b0 += w * nx * d; b1 += w * ny * d; b2 += w * nz * d;
+		c += w * d * d;
+		weight += w;
+	}
+
+	void add(const Quadric& other) {
+		a00 += other.a00; a01 += other.a01; a02 += other.a02;
+		a11 += other.a11; a12 += other.a12; a22 += other.a22;
+		b0 += other.b0; b1 += other.b1; b2 += other.b2;
+		c += other.c;
+		weight += other.weight;
+	}
+
+	// weighted sum of squared distances from p to the planes
+	double evaluate(const float* p) const {
+		double x = p[0], y = p[1], z = p[2];
+		double result = a00 * x * x + a11 * y * y + a22 * z * z
+			+ 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+			+ 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+		return result > 0.0 ? result : 0.0;
+	}
+};
+
+struct Simplifier::Region {
+	std::vector<uint32_t> indices; // 3 corners per triangle
+	std::vector<int> cornerUVs; // uv index of each corner, or empty when uvs are per vertex
+	std::vector<float> positions; // 3 floats per vertex
+	std::vector<uint8_t> locked; // 1 for vertices that must not move
+};
+
+struct Collapse {
+	float error;
+	uint32_t from;
+	uint32_t to;
+	uint32_t version; // version of 'from' when this was queued
+
+	bool operator>(const Collapse& other) const {
+		if (error != other.error) return error > other.error;
+		if (from != other.from) return from > other.from; // deterministic order between equal errors
+		return to > other.to;
+	}
+};
+
+static void triangleNormal(const float* a, const float* b, const float* c, double* normal)
+{
+	double e1[3] = { (double)b[0] - a[0], (double)b[1] - a[1], (double)b[2] - a[2] };
+	double e2[3] = { (double)c[0] - a[0], (double)c[1] - a[1], (double)c[2] - a[2] };
+	normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+	normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+	normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+void Simplifier::collapseEdges(Region& region, size_t targetTriangleCount, float maxError)
+{
+	const uint32_t none = 0xFFFFFFFF;
+	uint32_t* indices = region.indices.data();
+	int* cornerUVs = region.cornerUVs.empty() ? nullptr : region.cornerUVs.data();
+	const float* positions = region.positions.data();
+	const uint8_t* locked = region.locked.data();
+	size_t cornerCount = region.indices.size();
+	size_t triangleCount = cornerCount / 3;
+	size_t vertexCount = region.positions.size() / 3;
+	if (triangleCount <= targetTriangleCount) return;
+	double maxErrorSquared = maxError > 0.0f ? (double)maxError * maxError : HUGE_VAL;
+
+	// Triangle plane quadrics, weighted by area
+	std::vector<Quadric> quadrics(vertexCount);
+	for (size_t t = 0; t < triangleCount; t++) {
+		const uint32_t* tri = &indices[t * 3];
+		double normal[3];
+		triangleNormal(&positions[tri[0] * 3], &positions[tri[1] * 3], &positions[tri[2] * 3], normal);
+		double length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length == 0.0) continue;
+		double nx = normal[0] / length, ny = normal[1] / length, nz = normal[2] / length;
+		const float* p = &positions[tri[0] * 3];
+		double d = -(nx * p[0] + ny * p[1] + nz * p[2]);
+		for (int k = 0; k < 3; k++) quadrics[tri[k]].addPlane(nx, ny, nz, d, length * 0.5);
+	}
+
+	// Boundary edges are used by one triangle. Their vertices get a plane that holds them on the boundary.
+	std::vector<std::pair<uint64_t, uint32_t>> edges(cornerCount); // (sorted vertex pair, corner the edge starts at)
+	for (size_t c = 0; c < cornerCount; c++) {
+		uint64_t a = indices[c];
+		uint64_t b = indices[c - c % 3 + (c + 1) % 3];
+		edges[c] = { a < b ? (a << 32) | b : (b << 32) | a, (uint32_t)c };
+	}
+	std::sort(edges.begin(), edges.end());
+	std::vector<uint8_t> boundary(vertexCount, 0);
+	for (size_t i = 0; i < cornerCount; i++) {
+		if ((i > 0 && edges[i - 1].first == edges[i].first) || (i + 1 < cornerCount && edges[i + 1].first == edges[i].first)) continue;
+		size_t c = edges[i].second;
+		size_t t = c / 3;
+		uint32_t a = indices[c];
+		uint32_t b = indices[t * 3 + (c + 1) % 3];
+		const float* pa = &positions[a * 3];
+		const float* pb = &positions[b * 3];
+		double normal[3];
+		triangleNormal(&positions[indices[t * 3] * 3], &positions[indices[t * 3 + 1] * 3], &positions[indices[t * 3 + 2] * 3], normal);
+		double edge[3] = { (double)pb[0] - pa[0], (double)pb[1] - pa[1], (double)pb[2] - pa[2] };
+		double plane[3] = { edge[1] * normal[2] - edge[2] * normal[1], edge[2] * normal[0] - edge[0] * normal[2], edge[0] * normal[1] - edge[1] * normal[0] };
+		double length = sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+		boundary[a] = 1;
+		boundary[b] = 1;
+		if (length == 0.0) continue;
+		double edgeLength = sqrt(edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2]);
+		double nx = plane[0] / length, ny = plane[1] / length, nz = plane[2] / length;
+		double d = -(nx * pa[0] + ny * pa[1] + nz * pa[2]);
+		quadrics[a].addPlane(nx, ny, nz, d, boundaryWeight * edgeLength * edgeLength);
+		quadrics[b].addPlane(nx, ny, nz, d, boundaryWeight * edgeLength * edgeLength);
+	}
+	std::vector<std::pair<uint64_t, uint32_t>>().swap(edges);
+
+	// Corner rings: firstCorner[v] -> nextCorner[c] -> ... -> none
+	std::vector<uint32_t> firstCorner(vertexCount, none);
+	std::vector<uint32_t> nextCorner(cornerCount);
+	for (size_t c = cornerCount; c-- > 0;) {
+		nextCorner[c] = firstCorner[indices[c]];
+		firstCorner[indices[c]] = (uint32_t)c;
+	}
+	std::vector<uint8_t> triangleAlive(triangleCount, 1);
+	std::vector<uint8_t> vertexAlive(vertexCount, 1);
+	std::vector<uint32_t> versions(vertexCount, 0);
+	std::vector<uint32_t> stamps(vertexCount, 0);
+	std::vector<uint32_t> linkStamps(vertexCount, 0);
+	uint32_t stamp = 0;
+	uint32_t linkStamp = 0;
+
+	auto collapseError = [&](uint32_t from, uint32_t to) {
+		Quadric quadric = quadrics[from];
+		quadric.add(quadrics[to]);
+		double error = quadric.weight > 0.0 ? quadric.evaluate(&positions[to * 3]) / quadric.weight : 0.0;
+		// short edges first where the error is flat, so flat areas decimate evenly instead of growing huge fans
+		const float* a = &positions[from * 3];
+		const float* b = &positions[to * 3];
+		double dx = (double)a[0] - b[0], dy = (double)a[1] - b[1], dz = (double)a[2] - b[2];
+		return error + edgeLengthWeight * (dx * dx + dy * dy + dz * dz);
+	};
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+	// Each vertex has one entry in the queue: its cheapest collapse onto a neighbour. Queueing it again makes the old entry stale.
+	auto pushBest = [&](uint32_t v) {
+		versions[v]++;
+		if (locked[v]) return;
+		stamp++;
+		stamps[v] = stamp;
+		double bestError = HUGE_VAL;
+		uint32_t best = none;
+		for (uint32_t c = firstCorner[v]; c != none; c = nextCorner[c]) {
+			uint32_t t = c / 3;
+			if (!triangleAlive[t]) continue;
+			for (int k = 0; k < 3; k++) {
+				uint32_t w = indices[t * 3 + k];
+				if (stamps[w] == stamp) continue;
+				stamps[w] = stamp;
+				if (boundary[v] && !boundary[w]) continue;
+				double error = collapseError(v, w);
+				if (error < bestError) {
+					bestError = error;
+					best = w;
+				}
+			}
+		}
+		if (best != none) queue.push({ (float)bestError, v, best, versions[v] });
+	};
+	for (uint32_t v = 0; v < vertexCount; v++) {
+		if (firstCorner[v] != none) pushBest(v);
+	}
+	std::vector<uint32_t> neighbours;
+
+	size_t liveTriangles = triangleCount;
+	while (liveTriangles > targetTriangleCount && !queue.empty()) {
+		Collapse collapse = queue.top();
+		queue.pop();
+		uint32_t from = collapse.from;
+		uint32_t to = collapse.to;
+		if (!vertexAlive[from] || !vertexAlive[to]) continue;
+		if (collapse.version != versions[from]) continue; // stale
+		if (collapse.error > maxErrorSquared) break;
+
+		// Triangles on the edge, and the uv of 'to' on them
+		size_t sharedCount = 0;
+		int toUV = -1;
+		for (uint32_t c = firstCorner[from]; c != none; c = nextCorner[c]) {
+			uint32_t t = c / 3;
+			if (!triangleAlive[t]) continue;
+			for (int k = 0; k < 3; k++) {
+				if (indices[t * 3 + k] != to) continue;
+				sharedCount++;
+				if (cornerUVs) toUV = cornerUVs[t * 3 + k];
+			}
+		}
+		if (sharedCount == 0 || sharedCount > 2) continue;
+		if (boundary[from] && sharedCount != 1) continue; // boundary vertices only slide along boundary edges
+
+		// Link condition: the edge's end points may only share the vertices opposite the edge
+		linkStamp++;
+		size_t toTriangleCount = 0;
+		for (uint32_t c = firstCorner[to]; c != none; c = nextCorner[c]) {
+			uint32_t t = c / 3;
+			if (!triangleAlive[t]) continue;
+			toTriangleCount++;
+			for (int k = 0; k < 3; k++) linkStamps[indices[t * 3 + k]] = linkStamp;
+		}
+		if (toTriangleCount == sharedCount) continue; // would leave 'to' without triangles, e.g. the last triangle of a piece
+		stamp++;
+		size_t commonCount = 0;
+		for (uint32_t c = firstCorner[from]; c != none; c = nextCorner[c]) {
+			uint32_t t = c / 3;
+			if (!triangleAlive[t]) continue;
+			for (int k = 0; k < 3; k++) {
+				uint32_t w = indices[t * 3 + k];
+				if (w == from || w == to || stamps[w] == stamp) continue;
+				stamps[w] = stamp;
+				if (linkStamps[w] == linkStamp) commonCount++;
+			}
+		}
+		if (commonCount != sharedCount) continue;
+
+		// Don't grow fans around one vertex, which make every later collapse around it slower
+		size_t fromTriangleCount = 0;
+		for (uint32_t c = firstCorner[from]; c != none; c = nextCorner[c]) fromTriangleCount += triangleAlive[c / 3];
+		size_t newTriangleCount = toTriangleCount + fromTriangleCount - 2 * sharedCount;
+		if (newTriangleCount > maxVertexTriangles && newTriangleCount > std::max(toTriangleCount, fromTriangleCount)) continue;
+
+		// The remaining triangles of 'from' must not flip or collapse when it moves onto 'to'
+		bool valid = true;
+		for (uint32_t c = firstCorner[from]; c != none && valid; c = nextCorner[c]) {
+			uint32_t t = c / 3;
+			if (!triangleAlive[t]) continue;
+			const uint32_t* tri = &indices[t * 3];
+			if (tri[0] == to || tri[1] == to || tri[2] == to) continue;
+			const float* corners[3];
+			for (int k = 0; k < 3; k++) corners[k] = &positions[tri[k] * 3];
+			double before[3];
+			triangleNormal(corners[0], corners[1], corners[2], before);
+			corners[c % 3] = &positions[to * 3];
+			double after[3];
+			triangleNormal(corners[0], corners[1], corners[2], after);
+			double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+			double beforeLength = before[0] * before[0] + before[1] * before[1] + before[2] * before[2];
+			double afterLength = after[0] * after[0] + after[1] * after[1] + after[2] * after[2];
+			valid = dot > 0.0 && dot * dot > 0.0625 * beforeLength * afterLength; // less than ~75 degrees of rotation
+		}
+		if (!valid) continue;
+
+		// Collapse: kill the edge's triangles, move the corners of 'from' onto 'to' and merge the rings
+		quadrics[to].add(quadrics[from]);
+		uint32_t ring = none;
+		uint32_t* tail = &ring;
+		for (uint32_t c = firstCorner[from]; c != none; c = nextCorner[c]) {
+			uint32_t t = c / 3;
+			if (!triangleAlive[t]) continue;
+			const uint32_t* tri = &indices[t * 3];
+			if (tri[0] == to || tri[1] == to || tri[2] == to) {
+				triangleAlive[t] = 0;
+				liveTriangles--;
+				continue;
+			}
+			indices[c] = to;
+			if (cornerUVs && toUV >= 0) cornerUVs[c] = toUV;
+			*tail = c;
+			tail = &nextCorner[c];
+		}
+		for (uint32_t c = firstCorner[to]; c != none; c = nextCorner[c]) {
+			if (!triangleAlive[c / 3]) continue;
+			*tail = c;
+			tail = &nextCorner[c];
+		}
+		*tail = none;
+		firstCorner[to] = ring;
+		firstCorner[from] = none;
+		vertexAlive[from] = 0;
+
+		// 'to' and its neighbours have new collapse costs
+		neighbours.clear();
+		stamp++;
+		for (uint32_t c = firstCorner[to]; c != none; c = nextCorner[c]) {
+			for (int k = 0; k < 3; k++) {
+				uint32_t w = indices[c - c % 3 + k];
+				if (stamps[w] == stamp) continue;
+				stamps[w] = stamp;
+				neighbours.push_back(w);
+			}
+		}
+		for (uint32_t w : neighbours) pushBest(w);
+	}
+
+	// Keep the surviving triangles
+	size_t kept = 0;
+	for (size_t t = 0; t < triangleCount; t++) {
+		if (!triangleAlive[t]) continue;
+		memmove(&indices[kept * 3], &indices[t * 3], 3 * sizeof(uint32_t));
+		if (cornerUVs) memmove(&cornerUVs[kept * 3], &cornerUVs[t * 3], 3 * sizeof(int));
+		kept++;
+	}
+	region.indices.resize(kept * 3);
+	if (cornerUVs) region.cornerUVs.resize(kept * 3);
+}
+
+void Simplifier::findSeams(const MeshObject* mesh, std::vector<uint8_t>& locked)
+{
+	size_t vertexCount = mesh->vertices.size();
+	locked.assign(vertexCount, 0);
+
+	// split vertices: several vertices at the same position
+	std::vector<uint32_t> order(vertexCount);
+	for (uint32_t v = 0; v < vertexCount; v++) order[v] = v;
+	const MeshObject::Vertex* vertices = mesh->vertices.data();
+	auto samePosition = [&](uint32_t a, uint32_t b) {
+		return vertices[a].x == vertices[b].x && vertices[a].y == vertices[b].y && vertices[a].z == vertices[b].z;
+	};
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		if (vertices[a].x != vertices[b].x) return vertices[a].x < vertices[b].x;
+		if (vertices[a].y != vertices[b].y) return vertices[a].y < vertices[b].y;
+		return vertices[a].z < vertices[b].z;
+	});
+	for (size_t i = 1; i < vertexCount; i++) {
+		if (samePosition(order[i - 1], order[i])) {
+			locked[order[i - 1]] = 1;
+			locked[order[i]] = 1;
+		}
+	}
+
+	// per corner uvs: a vertex whose corners use different uvs
+	if (mesh->uvIndexes.size() == mesh->triangleList.size()) {
+		std::vector<int> vertexUVs(vertexCount, -1);
+		for (size_t c = 0; c < mesh->triangleList.size(); c++) {
+			uint32_t v = mesh->triangleList[c];
+			int uv = mesh->uvIndexes[c];
+			if (vertexUVs[v] < 0) vertexUVs[v] = uv;
+			else if (vertexUVs[v] != uv) locked[v] = 1;
+		}
+	}
+}
+
+void Simplifier::removeUnusedVertices(MeshObject* mesh)
+{
+	const uint32_t none = 0xFFFFFFFF;
+	size_t vertexCount = mesh->vertices.size();
+	bool perVertexUVs = mesh->uvIndexes.empty() && mesh->uvs.size() == vertexCount * 2;
+	std::vector<uint32_t> remap(vertexCount, none);
+	for (uint32_t v : mesh->triangleList) remap[v] = 0;
+	uint32_t next = 0;
+	for (size_t v = 0; v < vertexCount; v++) {
+		if (remap[v] == none) continue;
+		remap[v] = next;
+		mesh->vertices[next] = mesh->vertices[v];
+		if (perVertexUVs) {
+			mesh->uvs[next * 2] = mesh->uvs[v * 2];
+			mesh->uvs[next * 2 + 1] = mesh->uvs[v * 2 + 1];
+		}
+		next++;
+	}
+	mesh->vertices.resize(next);
+	if (perVertexUVs) mesh->uvs.resize((size_t)next * 2);
+	for (uint32_t& v : mesh->triangleList) v = remap[v];
+}
+
+size_t Simplifier::simplify(MeshObject* mesh, size_t targetTriangleCount, float maxError, int threadCount)
+{
+	auto start = Timer::begin();
+	threadCount = Parallel::threadCount(threadCount);
+	size_t triangleCount = mesh->triangleList.size() / 3;
+	size_t vertexCount = mesh->vertices.size();
+	if (triangleCount <= targetTriangleCount) return 0;
+	bool hasCornerUVs = mesh->uvIndexes.size() == mesh->triangleList.size();
+	std::vector<uint8_t> locked;
+	findSeams(mesh, locked);
+
+	if (triangleCount >= parallelTriangleCount && threadCount > 1) {
+		// Slabs along the longest axis, with equal triangle counts
+		const MeshObject::Vertex* vertices = mesh->vertices.data();
+		const uint32_t* indices = mesh->triangleList.data();
+		float low[3] = { HUGE_VALF, HUGE_VALF, HUGE_VALF };
+		float high[3] = { -HUGE_VALF, -HUGE_VALF, -HUGE_VALF };
+		for (const MeshObject::Vertex& vertex : mesh->vertices) {
+			const float* p = &vertex.x;
+			for (int d = 0; d < 3; d++) {
+				low[d] = std::min(low[d], p[d]);
+				high[d] = std::max(high[d], p[d]);
+			}
+		}
+		int axis = 0;
+		for (int d = 1; d < 3; d++) {
+			if (high[d] - low[d] > high[axis] - low[axis]) axis = d;
+		}
+		std::vector<std::pair<float, uint32_t>> centroids(triangleCount);
+		for (size_t t = 0; t < triangleCount; t++) {
+			const uint32_t* tri = &indices[t * 3];
+			float centroid = (&vertices[tri[0]].x)[axis] + (&vertices[tri[1]].x)[axis] + (&vertices[tri[2]].x)[axis];
+			centroids[t] = { centroid, (uint32_t)t };
+		}
+		std::sort(centroids.begin(), centroids.end());
+		int partitionCount = threadCount;
+		std::vector<int> triangleRegion(triangleCount);
+		for (size_t i = 0; i < triangleCount; i++) {
+			triangleRegion[centroids[i].second] = (int)(i * partitionCount / triangleCount);
+		}
+
+		// Vertices used by more than one slab sit on a cut
+		std::vector<int> vertexRegion(vertexCount, -1);
+		for (size_t c = 0; c < triangleCount * 3; c++) {
+			int& owner = vertexRegion[indices[c]];
+			int r = triangleRegion[c / 3];
+			if (owner == -1) owner = r;
+			else if (owner != r) owner = -2;
+		}
+
+		std::vector<Region> regions(partitionCount);
+		std::vector<std::vector<uint32_t>> regionVertices(partitionCount);
+		Parallel::forRange(partitionCount, threadCount, [&](size_t begin, size_t end, int) {
+			std::vector<uint32_t> localIndex(vertexCount, 0xFFFFFFFF);
+			for (size_t r = begin; r < end; r++) {
+				Region& region = regions[r];
+				std::vector<uint32_t>& globalIndex = regionVertices[r];
+				for (size_t t = 0; t < triangleCount; t++) {
+					if (triangleRegion[t] != (int)r) continue;
+					for (int k = 0; k < 3; k++) {
+						uint32_t v = indices[t * 3 + k];
+						if (localIndex[v] == 0xFFFFFFFF) {
+							localIndex[v] = (uint32_t)globalIndex.size();
+							globalIndex.push_back(v);
+							region.positions.insert(region.positions.end(), { vertices[v].x, vertices[v].y, vertices[v].z });
+							region.locked.push_back(locked[v] || vertexRegion[v] == -2);
+						}
+						region.indices.push_back(localIndex[v]);
+						if (hasCornerUVs) region.cornerUVs.push_back(mesh->uvIndexes[t * 3 + k]);
+					}
+				}
+				size_t regionTarget = (size_t)((double)(region.indices.size() / 3) * targetTriangleCount / triangleCount);
+				collapseEdges(region, regionTarget, maxError);
+				for (uint32_t v : globalIndex) localIndex[v] = 0xFFFFFFFF;
+			}
+		});
+
+		mesh->triangleList.clear();
+		if (hasCornerUVs) mesh->uvIndexes.clear();
+		for (int r = 0; r < partitionCount; r++) {
+			for (uint32_t v : regions[r].indices) mesh->triangleList.push_back(regionVertices[r][v]);
+			if (hasCornerUVs) mesh->uvIndexes.insert(mesh->uvIndexes.end(), regions[r].cornerUVs.begin(), regions[r].cornerUVs.end());
+		}
+		std::cout << "Simplified (" << partitionCount << ") slabs in parallel: " << triangleCount << " -> " << mesh->triangleList.size() / 3 << " triangles" << std::endl;
+	}
+
+	// Whole mesh, which also collapses across the slab cuts
+	Region region;
+	region.indices.swap(mesh->triangleList);
+	if (hasCornerUVs) region.cornerUVs.swap(mesh->uvIndexes);
+	region.positions.resize(vertexCount * 3);
+	for (size_t v = 0; v < vertexCount; v++) {
+		memcpy(&region.positions[v * 3], &mesh->vertices[v].x, 3 * sizeof(float));
+	}
+	region.locked.swap(locked);
+	collapseEdges(region, targetTriangleCount, maxError);
+	mesh->triangleList.swap(region.indices);
+	if (hasCornerUVs) mesh->uvIndexes.swap(region.cornerUVs);
+	removeUnusedVertices(mesh);
+
+	size_t newTriangleCount = mesh->triangleList.size() / 3;
+	std::cout << "Simplified mesh: " << triangleCount << " -> " << newTriangleCount << " triangles, "
+		<< vertexCount << " -> " << mesh->vertices.size() << " vertices" << std::endl;
+	Timer::end(start, "Simplified mesh: ");
+	return triangleCount - newTriangleCount;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef SRC_MESHOPTIMIZER_SIMPLIFIER_H_
+#define SRC_MESHOPTIMIZER_SIMPLIFIER_H_
+
+#include <vector>
+#include <cstdint>
+#include <model/MeshObject.h>
+
+class Simplifier {
+private:
+	/// <summary>
+	/// A piece of the mesh simplified on its own, with its own vertex numbering.
+	/// </summary>
+	struct Region;
+
+	/// <summary>
+	/// <para/>Collapse edges of a region, cheapest first, until it has targetTriangleCount triangles left,
+	/// or the next collapse would exceed maxError.
+	/// <para/>Each vertex keeps its cheapest collapse in a priority queue, stamped with the vertex's version. When a collapse changes
+	/// the costs around a vertex it is queued again with a new version, and the old entry is skipped when popped,
+	/// instead of being searched for and updated. A vertex whose best collapse is rejected waits until its neighbourhood changes.
+	/// <para/>Adjacency is a corner table: region.indices holds the vertex of each corner, and the corners of each vertex
+	/// are linked into a ring through flat arrays, which collapses splice together.
+	/// <para/>Collapses move a vertex onto its neighbour (half edge collapse), so vertex attributes never need interpolating.
+	/// Locked vertices never move, boundary vertices only move along the boundary, and collapses that flip a triangle or
+	/// make the mesh non-manifold are rejected.
+	/// </summary>
+	/// <param name="region">- region to simplify in place</param>
+	/// <param name="targetTriangleCount">- triangles to keep</param>
+	/// <param name="maxError">- largest allowed distance from the original surface, 0 for no limit</param>
+	static void collapseEdges(Region& region, size_t targetTriangleCount, float maxError);
+
+	/// <summary>
+	/// <para/>Lock the vertices on uv seams and hard edges, which are either split vertices sharing a position,
+	/// or vertices whose corners use different uv indexes.
+	/// </summary>
+	/// <param name="mesh">- mesh to check</param>
+	/// <param name="locked">- 1 for each vertex that must not move</param>
+	static void findSeams(const MeshObject* mesh, std::vector<uint8_t>& locked);
+
+	/// <summary>
+	/// Remove vertices that no triangle uses anymore, along with their uv coords when uvs are per vertex.
+	/// </summary>
+	/// <param name="mesh">- mesh to compact in place</param>
+	static void removeUnusedVertices(MeshObject* mesh);
+public:
+	/// <summary>
+	/// Meshes with fewer triangles than this are simplified on one thread.
+	/// </summary>
+	static const size_t parallelTriangleCount = 200000;
+
+	/// <summary>
+	/// <para/>Reduce mesh.triangleList to targetTriangleCount triangles with quadric error edge collapses (Garland and Heckbert),
+	/// or fewer collapses if maxError is reached first.
+	/// <para/>UV seams, hard edges and boundaries keep their shape.
+	/// <para/>Big meshes are cut into slabs along their longest axis, which are simplified in parallel with the vertices on
+	/// the cuts locked, followed by a pass over the whole mesh that finishes the job across the cuts.
+	/// <para/>Works on split vertices (per vertex uvs) as well as on per corner uvIndexes. Unused vertices are removed afterwards.
+	/// </summary>
+	/// <param name="mesh">- mesh to simplify in place</param>
+	/// <param name="targetTriangleCount">- number of triangles to keep</param>
+	/// <param name="maxError">- largest allowed distance from the original surface, 0 for no limit</param>
+	/// <param name="threadCount">- number of threads to use, 0 for one per hardware thread</param>
+	/// <returns>Number of triangles removed</returns>
+	static size_t simplify(MeshObject* mesh, size_t targetTriangleCount, float maxError = 0.0f, int threadCount = 0);
+};
+
+#endif
\ No newline at end of file
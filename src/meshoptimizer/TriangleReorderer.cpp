@@ -0,0 +1,98 @@
+#include <string>
+#include <algorithm>
+#include <meshoptimizer/TriangleReorderer.h>
+#include <util/Parallel.hpp>
+#include <util/Timer.hpp>
+
+uint32_t TriangleReorderer::mortonCode(uint32_t x, uint32_t y, uint32_t z)
+{
+	// spread the 10 bits of a coordinate out to every third bit
+	auto spread = [](uint32_t value) {
+		value = (value | (value << 16)) & 0x030000FF;
+		value = (value | (value << 8)) & 0x0300F00F;
+		value = (value | (value << 4)) & 0x030C30C3;
+		value = (value | (value << 2)) & 0x09249249;
+		return value;
+	};
+	return spread(x) | (spread(y) << 1) | (spread(z) << 2);
+}
+
+template <typename CornerType>
+void TriangleReorderer::permuteCorners(std::vector<CornerType>& corners, const int* order, int threadCount)
+{
+	size_t triangleCount = corners.size() / 3;
+	std::vector<CornerType> reordered(corners.size());
+	const CornerType* source = corners.data();
+	CornerType* destination = reordered.data();
+	Parallel::forRange(triangleCount, threadCount, [&](size_t begin, size_t end, int) {
+		for (size_t t = begin; t < end; t++) {
+			size_t old = (size_t)order[t];
+			destination[t * 3] = source[old * 3];
+			destination[t * 3 + 1] = source[old * 3 + 1];
+			destination[t * 3 + 2] = source[old * 3 + 2];
+		}
+	}, Parallel::itemGrain);
+	corners.swap(reordered);
+}
+
+void TriangleReorderer::reorderSpatially(MeshObject* mesh, int threadCount, std::vector<uint32_t>* newToOld)
+{
+	auto start = Timer::begin();
+	threadCount = Parallel::threadCount(threadCount);
+	size_t triangleCount = mesh->triangleList.size() / 3;
+	size_t vertexCount = mesh->vertices.size();
+	if (newToOld) newToOld->resize(triangleCount);
+	if (triangleCount < 2 || vertexCount == 0) {
+		if (newToOld) for (size_t t = 0; t < triangleCount; t++) (*newToOld)[t] = (uint32_t)t;
+		return;
+	}
+
+	const MeshObject::Vertex* vertices = mesh->vertices.data();
+	float minimum[3] = { vertices[0].x, vertices[0].y, vertices[0].z };
+	float maximum[3] = { vertices[0].x, vertices[0].y, vertices[0].z };
+	for (size_t v = 1; v < vertexCount; v++) {
+		const float position[3] = { vertices[v].x, vertices[v].y, vertices[v].z };
+		for (int axis = 0; axis < 3; axis++) {
+			minimum[axis] = std::min(minimum[axis], position[axis]);
+			maximum[axis] = std::max(maximum[axis], position[axis]);
+		}
+	}
+	// centroids are summed rather than averaged, so the scale takes the 3 corners into account
+	const float steps = (float)((1 << mortonBits) - 1);
+	float scale[3];
+	for (int axis = 0; axis < 3; axis++) {
+		float extent = maximum[axis] - minimum[axis];
+		scale[axis] = extent > 0.0f ? steps / (extent * 3.0f) : 0.0f;
+	}
+
+	const uint32_t* triangleList = mesh->triangleList.data();
+	std::vector<uint32_t> codes(triangleCount);
+	uint32_t* codesPtr = codes.data();
+	Parallel::forRange(triangleCount, threadCount, [&](size_t begin, size_t end, int) {
+		for (size_t t = begin; t < end; t++) {
+			const MeshObject::Vertex& a = vertices[triangleList[t * 3]];
+			const MeshObject::Vertex& b = vertices[triangleList[t * 3 + 1]];
+			const MeshObject::Vertex& c = vertices[triangleList[t * 3 + 2]];
+			const float sum[3] = { a.x + b.x + c.x, a.y + b.y + c.y, a.z + b.z + c.z };
+			uint32_t quantized[3];
+			for (int axis = 0; axis < 3; axis++) {
+				float value = (sum[axis] - minimum[axis] * 3.0f) * scale[axis];
+				quantized[axis] = (uint32_t)std::min(std::max(value, 0.0f), steps);
+			}
+			codesPtr[t] = mortonCode(quantized[0], quantized[1], quantized[2]);
+		}
+	}, Parallel::itemGrain);
+	// the triangles in code order are the new triangle order, triangles with the same code keep theirs
+	std::vector<int> order;
+	CodeSorter::Workspace workspace;
+	CodeSorter::sortIndices(codes, order, workspace, threadCount);
+	const int* orderPtr = order.data();
+
+	// per corner arrays move with their triangle
+	permuteCorners(mesh->triangleList, orderPtr, threadCount);
+	if (mesh->uvIndexes.size() == triangleCount * 3) permuteCorners(mesh->uvIndexes, orderPtr, threadCount);
+	if (mesh->cornerNormals.size() == triangleCount * 3) permuteCorners(mesh->cornerNormals, orderPtr, threadCount);
+	if (newToOld) for (size_t t = 0; t < triangleCount; t++) (*newToOld)[t] = (uint32_t)orderPtr[t];
+
+	Timer::end(start, "Sorted (" + std::to_string(triangleCount) + ") triangles along a Morton curve: ");
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef SRC_MESHOPTIMIZER_TRIANGLEREORDERER_H_
+#define SRC_MESHOPTIMIZER_TRIANGLEREORDERER_H_
+
+#include <vector>
+#include <cstdint>
+#include <model/MeshObject.h>
+#include <util/KeySorter.hpp>
+
+class TriangleReorderer {
+private:
+	static const int mortonBits = 10; // bits per axis, 30 bit codes
+	typedef KeySorter<uint32_t> CodeSorter; // 3 passes of 11 bit digits over the 30 bit codes
+
+	/// <summary>
+	/// Interleave the bits of 3 coordinates, x in the lowest bit, so points that are close in space get close codes.
+	/// </summary>
+	/// <param name="x">- coordinate quantized to mortonBits bits</param>
+	/// <param name="y">- coordinate quantized to mortonBits bits</param>
+	/// <param name="z">- coordinate quantized to mortonBits bits</param>
+	/// <returns>30 bit Morton code</returns>
+	static uint32_t mortonCode(uint32_t x, uint32_t y, uint32_t z);
+
+	/// <summary>
+	/// Move the 3 corners of every triangle to its new place.
+	/// </summary>
+	/// <param name="corners">- 3 values per triangle, reordered in place</param>
+	/// <param name="order">- old index of every new triangle</param>
+	/// <param name="threadCount">- threads to copy with</param>
+	template <typename CornerType>
+	static void permuteCorners(std::vector<CornerType>& corners, const int* order, int threadCount);
+public:
+	/// <summary>
+	/// <para/>Renumber the triangles along a Morton curve through their centroids, so triangles that share edges mostly sit
+	/// close together in the triangle list. FBX polygon order is often close to random, which makes the adjacency lookups of
+	/// the stripers jump all over memory.
+	/// <para/>The centroids are quantized to 1024 steps per axis of the bounding box, and sorted with KeySorter on threadCount threads.
+	/// Triangles with the same code keep their order. The corners of a triangle are not rotated, so the winding is kept.
+	/// <para/>Per corner attributes (uvIndexes, cornerNormals) move with their triangle.
+	/// </summary>
+	/// <param name="mesh">- mesh with a triangle list, reordered in place</param>
+	/// <param name="threadCount">- threads to use, 0 or less for one per hardware thread</param>
+	/// <param name="newToOld">- optional, filled with the old index of every new triangle</param>
+	static void reorderSpatially(MeshObject* mesh, int threadCount, std::vector<uint32_t>* newToOld = nullptr);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include <string>
+#include <meshoptimizer/VertexReorderer.h>
+#include <util/Timer.hpp>
+
+template <typename IndexType>
+void VertexReorderer::buildFirstUseRemap(const IndexType* indices, size_t indexCount, size_t valueCount, std::vector<uint32_t>& remap)
+{
+	remap.assign(valueCount, 0xFFFFFFFF);
+	uint32_t* remapPtr = remap.data();
+	uint32_t next = 0;
+	for (size_t i = 0; i < indexCount; i++) {
+		size_t index = (size_t)indices[i];
+		if (index >= valueCount) continue; // missing references, e.g. a uv index of -1
+		if (remapPtr[index] == 0xFFFFFFFF) remapPtr[index] = next++;
+	}
+	for (size_t i = 0; i < valueCount; i++) {
+		if (remapPtr[i] == 0xFFFFFFFF) remapPtr[i] = next++;
+	}
+}
+
+void VertexReorderer::reorderByFirstUse(MeshObject* mesh)
+{
+#if _DEBUG
+	auto start = Timer::begin();
+#endif
+	size_t vertexCount = mesh->vertices.size();
+	std::vector<uint32_t> remap;
+	std::vector<uint32_t> usage;
+	if (mesh->primitiveType == MeshObject::PrimitiveType::TriangleList) {
+		buildFirstUseRemap(mesh->triangleList.data(), mesh->triangleList.size(), vertexCount, remap);
+	}
+	else {
+		// strips are walked in the order they're drawn
+		for (const std::vector<uint16_t>& strip : mesh->triangleStrips) {
+			usage.insert(usage.end(), strip.begin(), strip.end());
+		}
+		buildFirstUseRemap(usage.data(), usage.size(), vertexCount, remap);
+	}
+	uint32_t* remapPtr = remap.data();
+
+	// vertices carry their normals with them
+	std::vector<MeshObject::Vertex> vertices(vertexCount);
+	MeshObject::Vertex* oldVertices = mesh->vertices.data();
+	for (size_t i = 0; i < vertexCount; i++) {
+		vertices[remapPtr[i]] = oldVertices[i];
+	}
+	mesh->vertices.swap(vertices);
+
+	// split vertices have one uv coord each, which moves with its vertex
+	if (mesh->uvIndexes.empty() && mesh->uvs.size() == vertexCount * 2) {
+		std::vector<float> uvs(vertexCount * 2);
+		float* oldUVs = mesh->uvs.data();
+		for (size_t i = 0; i < vertexCount; i++) {
+			uvs[remapPtr[i] * 2] = oldUVs[i * 2];
+			uvs[remapPtr[i] * 2 + 1] = oldUVs[i * 2 + 1];
+		}
+		mesh->uvs.swap(uvs);
+	}
+
+	for (std::vector<uint16_t>& strip : mesh->triangleStrips) {
+		uint16_t* stripPtr = strip.data();
+		for (size_t i = 0; i < strip.size(); i++) {
+			stripPtr[i] = (uint16_t)remapPtr[stripPtr[i]];
+		}
+	}
+	uint32_t* triangleListPtr = mesh->triangleList.data();
+	for (size_t i = 0; i < mesh->triangleList.size(); i++) {
+		triangleListPtr[i] = remapPtr[triangleListPtr[i]];
+	}
+
+	// uv coords, 2 floats each, in the order uvIndexes first references them
+	size_t uvCount = mesh->uvs.size() / 2;
+	if (uvCount > 0 && !mesh->uvIndexes.empty()) {
+		buildFirstUseRemap(mesh->uvIndexes.data(), mesh->uvIndexes.size(), uvCount, remap);
+		remapPtr = remap.data();
+		std::vector<float> uvs(uvCount * 2);
+		float* oldUVs = mesh->uvs.data();
+		for (size_t i = 0; i < uvCount; i++) {
+			uvs[remapPtr[i] * 2] = oldUVs[i * 2];
+			uvs[remapPtr[i] * 2 + 1] = oldUVs[i * 2 + 1];
+		}
+		mesh->uvs.swap(uvs);
+		int* uvIndexesPtr = mesh->uvIndexes.data();
+		for (size_t i = 0; i < mesh->uvIndexes.size(); i++) {
+			if ((size_t)uvIndexesPtr[i] < uvCount) uvIndexesPtr[i] = (int)remapPtr[uvIndexesPtr[i]];
+		}
+	}
+
+#if _DEBUG
+	Timer::end(start, "Reordered (" + std::to_string(vertexCount) + ") vertices by first use: ");
+#endif
+}
\ No newline at end of file
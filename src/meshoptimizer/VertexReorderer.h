@@ -0,0 +1,31 @@
+#ifndef SRC_MESHOPTIMIZER_VERTEXREORDERER_H_
+#define SRC_MESHOPTIMIZER_VERTEXREORDERER_H_
+
+#include <vector>
+#include <cstdint>
+#include <model/MeshObject.h>
+
+class VertexReorderer {
+private:
+	/// <summary>
+	/// <para/>Give every referenced value a new index in the order it is first referenced.
+	/// <para/>Values that are never referenced are placed after the referenced ones, in their original order.
+	/// </summary>
+	/// <param name="indices">- references in draw order</param>
+	/// <param name="indexCount">- number of references</param>
+	/// <param name="valueCount">- number of values being referenced</param>
+	/// <param name="remap">- old index -> new index</param>
+	template <typename IndexType>
+	static void buildFirstUseRemap(const IndexType* indices, size_t indexCount, size_t valueCount, std::vector<uint32_t>& remap);
+public:
+	/// <summary>
+	/// <para/>Renumber the vertices in the order the triangle strips (or triangle list) first reference them, so vertex fetches
+	/// while drawing walk forwards through memory, and the indices grow slowly, which suits delta coding.
+	/// <para/>The strips, the triangle list and the vertex normals are remapped to match.
+	/// <para/>UV coords are renumbered the same way, in the order uvIndexes first references them, or move with their vertex once vertices are split.
+	/// </summary>
+	/// <param name="mesh">- mesh to reorder in place</param>
+	static void reorderByFirstUse(MeshObject* mesh);
+};
+
+#endif
\ No newline at end of file
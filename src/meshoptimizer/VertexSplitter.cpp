@@ -0,0 +1,109 @@
+#include <cstring>
+#include <string>
+#include <meshoptimizer/VertexSplitter.h>
+#include <util/Timer.hpp>
+
+struct CornerKey {
+	uint32_t position;
+	int uv;
+	MeshObject::Normal normal;
+
+	bool operator==(const CornerKey& other) const {
+		return position == other.position && uv == other.uv && memcmp(&normal, &other.normal, sizeof(MeshObject::Normal)) == 0;
+	}
+
+	uint32_t hash() const {
+		uint32_t words[5] = { position, (uint32_t)uv, 0, 0, 0 };
+		memcpy(&words[2], &normal, sizeof(MeshObject::Normal));
+		uint32_t hash = 2166136261u;
+		for (uint32_t word : words) {
+			hash = (hash ^ word) * 16777619u;
+		}
+		return hash ^ (hash >> 15);
+	}
+};
+
+bool VertexSplitter::splitVertices(MeshObject* mesh)
+{
+	auto start = Timer::begin();
+	size_t cornerCount = mesh->triangleList.size();
+	size_t positionCount = mesh->vertices.size();
+	bool hasUVs = mesh->uvIndexes.size() == cornerCount;
+	bool hasNormals = mesh->cornerNormals.size() == cornerCount;
+	uint32_t* triangles = mesh->triangleList.data();
+	const int* uvIndexes = mesh->uvIndexes.data();
+	const MeshObject::Normal* cornerNormals = mesh->cornerNormals.data();
+	auto cornerKey = [&](size_t corner) {
+		CornerKey key;
+		key.position = triangles[corner];
+		key.uv = hasUVs ? uvIndexes[corner] : -1;
+		if (hasNormals) key.normal = cornerNormals[corner];
+		return key;
+	};
+
+	// Each slot holds a new vertex, identified by the first corner that created it
+	const uint32_t none = 0xFFFFFFFF;
+	size_t tableSize = 1;
+	while (tableSize < cornerCount * 2) tableSize <<= 1;
+	size_t mask = tableSize - 1;
+	std::vector<uint32_t> table(tableSize, none);
+	std::vector<uint32_t> firstCorners;
+	std::vector<uint32_t> cornerVertices(cornerCount);
+	firstCorners.reserve(positionCount);
+	for (size_t corner = 0; corner < cornerCount; corner++) {
+		CornerKey key = cornerKey(corner);
+		size_t slot = key.hash() & mask;
+		while (table[slot] != none && !(cornerKey(firstCorners[table[slot]]) == key)) {
+			slot = (slot + 1) & mask;
+		}
+		if (table[slot] == none) {
+			table[slot] = (uint32_t)firstCorners.size();
+			firstCorners.push_back((uint32_t)corner);
+		}
+		cornerVertices[corner] = table[slot];
+	}
+
+	// Build the new vertices with their own uv and normal, unless their indices wouldn't fit in 2 bytes
+	size_t vertexCount = firstCorners.size();
+	if (vertexCount > maxVertexCount) {
+		std::cout << "Splitting vertices by (position, uv, normal) would make " << vertexCount << " vertices, more than " << maxVertexCount
+			<< ", keeping uv indexes separate instead" << std::endl;
+		return false;
+	}
+	std::vector<MeshObject::Vertex> vertices(vertexCount);
+	std::vector<float> uvs(hasUVs ? vertexCount * 2 : 0);
+	size_t uvCount = mesh->uvs.size() / 2;
+	for (size_t v = 0; v < vertexCount; v++) {
+		CornerKey key = cornerKey(firstCorners[v]);
+		vertices[v] = mesh->vertices[key.position];
+		if (hasNormals) vertices[v].setNormal(key.normal.x, key.normal.y, key.normal.z);
+		if (hasUVs && (size_t)key.uv < uvCount) {
+			uvs[v * 2] = mesh->uvs[key.uv * 2];
+			uvs[v * 2 + 1] = mesh->uvs[key.uv * 2 + 1];
+		}
+	}
+	memcpy(triangles, cornerVertices.data(), cornerCount * sizeof(uint32_t));
+	mesh->vertices.swap(vertices);
+	if (hasUVs) mesh->uvs.swap(uvs);
+	mesh->uvIndexes.clear();
+	mesh->cornerNormals.clear();
+
+	std::cout << "Split vertices by (position, uv, normal): " << positionCount << " -> " << vertexCount << std::endl;
+	Timer::end(start, "Split vertices: ");
+	return true;
+}
+
+void VertexSplitter::applyCornerNormals(MeshObject* mesh)
+{
+	if (mesh->cornerNormals.size() != mesh->triangleList.size()) return;
+	std::vector<char> assigned(mesh->vertices.size(), 0);
+	MeshObject::Vertex* vertices = mesh->vertices.data();
+	for (size_t corner = 0; corner < mesh->triangleList.size(); corner++) {
+		uint32_t v = mesh->triangleList[corner];
+		if (assigned[v]) continue;
+		assigned[v] = 1;
+		const MeshObject::Normal& normal = mesh->cornerNormals[corner];
+		vertices[v].setNormal(normal.x, normal.y, normal.z);
+	}
+	mesh->cornerNormals.clear();
+}
\ No newline at end of file
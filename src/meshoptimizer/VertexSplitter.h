@@ -0,0 +1,33 @@
+#ifndef SRC_MESHOPTIMIZER_VERTEXSPLITTER_H_
+#define SRC_MESHOPTIMIZER_VERTEXSPLITTER_H_
+
+#include <vector>
+#include <cstdint>
+#include <model/MeshObject.h>
+
+class VertexSplitter {
+public:
+	static const size_t maxVertexCount = 65536; // strips and .m files store 2 byte vertex indices
+
+	/// <summary>
+	/// <para/>Give every distinct (position, uv, normal) combination used by a triangle corner its own vertex, so one index
+	/// buffer addresses every attribute, the way GPU pipelines expect.
+	/// <para/>Before: mesh.triangleList indexes positions, mesh.uvIndexes and mesh.cornerNormals hold the uv and normal of each corner.
+	/// <para/>After: mesh.triangleList indexes the new vertices, mesh.uvs holds one uv coord per vertex, each vertex has its normal,
+	/// and mesh.uvIndexes and mesh.cornerNormals are empty.
+	/// <para/>Vertices are numbered in the order their first corner appears. Positions only get duplicated along uv seams and hard edges.
+	/// <para/>If the split would need more than maxVertexCount vertices, the mesh is left as it is, so the caller can keep the uvs
+	/// separate instead of truncating indices.
+	/// </summary>
+	/// <param name="mesh">- mesh to split in place</param>
+	/// <returns>False if the mesh wasn't split because of the vertex count</returns>
+	static bool splitVertices(MeshObject* mesh);
+
+	/// <summary>
+	/// Copy mesh.cornerNormals onto the vertices without splitting. A vertex takes the normal of the first corner that uses it.
+	/// </summary>
+	/// <param name="mesh">- mesh to update in place</param>
+	static void applyCornerNormals(MeshObject* mesh);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <meshoptimizer/VertexWelder.h>
+#include <util/Parallel.hpp>
+#include <util/Timer.hpp>
+
+static uint32_t hashCell(const int64_t* cell, int dimensions)
+{
+	uint32_t hash = 0;
+	for (int d = 0; d < dimensions; d++) {
+		uint64_t coordinate = (uint64_t)cell[d];
+		hash ^= (uint32_t)(coordinate ^ (coordinate >> 32)) * 0x9E3779B1u;
+		hash = (hash << 13) | (hash >> 19);
+		hash *= 0x85EBCA77u;
+	}
+	return hash ^ (hash >> 16);
+}
+
+template <int Dimensions>
+size_t VertexWelder::buildWeldRemap(const float* values, size_t stride, size_t count, float epsilon, int threadCount, std::vector<uint32_t>& remap)
+{
+	const uint32_t none = 0xFFFFFFFF;
+	double cellSize = epsilon > 0.0f ? epsilon : 1e-30;
+	float epsilonSquared = epsilon * epsilon;
+
+	// Grid cell of every value. 64 bit coordinates, so only values too far out to weld anything share the clamped cells.
+	std::vector<int64_t> cells(count * Dimensions);
+	int64_t* cellsPtr = cells.data();
+	Parallel::forRange(count, threadCount, [&](size_t begin, size_t end, int) {
+		const double cellLimit = 4611686018427387904.0; // 2^62, leaves room for the neighbour offsets
+		for (size_t i = begin; i < end; i++) {
+			const float* value = &values[i * stride];
+			for (int d = 0; d < Dimensions; d++) {
+				double cell = floor(value[d] / cellSize);
+				cellsPtr[i * Dimensions + d] = (int64_t)std::max(-cellLimit, std::min(cell, cellLimit));
+			}
+		}
+	}, Parallel::itemGrain);
+
+	// Hash grid. Each slot holds the first value of a cell, the rest of the cell is chained through next.
+	size_t tableSize = 1;
+	while (tableSize < count * 2) tableSize <<= 1;
+	size_t mask = tableSize - 1;
+	std::vector<uint32_t> table(tableSize, none);
+	std::vector<uint32_t> next(count, none);
+	std::vector<uint32_t> last(tableSize, none);
+	uint32_t* tablePtr = table.data();
+	uint32_t* nextPtr = next.data();
+	for (size_t i = 0; i < count; i++) {
+		const int64_t* cell = &cellsPtr[i * Dimensions];
+		size_t slot = hashCell(cell, Dimensions) & mask;
+		while (tablePtr[slot] != none && memcmp(&cellsPtr[tablePtr[slot] * Dimensions], cell, Dimensions * sizeof(int64_t)) != 0) {
+			slot = (slot + 1) & mask;
+		}
+		if (tablePtr[slot] == none) tablePtr[slot] = (uint32_t)i;
+		else nextPtr[last[slot]] = (uint32_t)i;
+		last[slot] = (uint32_t)i;
+	}
+
+	// Lowest index value within epsilon, searching the neighbouring cells
+	std::vector<uint32_t> nearest(count);
+	uint32_t* nearestPtr = nearest.data();
+	Parallel::forRange(count, threadCount, [&](size_t begin, size_t end, int) {
+		int64_t neighbour[Dimensions];
+		for (size_t i = begin; i < end; i++) {
+			const float* value = &values[i * stride];
+			const int64_t* cell = &cellsPtr[i * Dimensions];
+			uint32_t best = (uint32_t)i;
+			int neighbourCount = 1;
+			for (int d = 0; d < Dimensions; d++) neighbourCount *= 3;
+			for (int n = 0; n < neighbourCount; n++) {
+				int offsets = n;
+				for (int d = 0; d < Dimensions; d++) {
+					neighbour[d] = cell[d] + (offsets % 3) - 1;
+					offsets /= 3;
+				}
+				size_t slot = hashCell(neighbour, Dimensions) & mask;
+				while (tablePtr[slot] != none && memcmp(&cellsPtr[tablePtr[slot] * Dimensions], neighbour, Dimensions * sizeof(int64_t)) != 0) {
+					slot = (slot + 1) & mask;
+				}
+				// values in a cell are chained in increasing index order, so stop once we pass the current best
+				for (uint32_t j = tablePtr[slot]; j != none && j < best; j = nextPtr[j]) {
+					const float* other = &values[(size_t)j * stride];
+					float distanceSquared = 0.0f;
+					for (int d = 0; d < Dimensions; d++) {
+						float delta = value[d] - other[d];
+						distanceSquared += delta * delta;
+					}
+					if (distanceSquared <= epsilonSquared) {
+						best = j;
+						break;
+					}
+				}
+			}
+			nearestPtr[i] = best;
+		}
+	}, Parallel::itemGrain);
+
+	// Resolve chains in index order and number the groups
+	remap.resize(count);
+	uint32_t* remapPtr = remap.data();
+	uint32_t uniqueCount = 0;
+	for (size_t i = 0; i < count; i++) {
+		if (nearestPtr[i] == i) remapPtr[i] = uniqueCount++;
+		else remapPtr[i] = remapPtr[nearestPtr[i]];
+	}
+	return uniqueCount;
+}
+
+size_t VertexWelder::removeDegenerateTriangles(MeshObject* mesh)
+{
+	uint32_t* triangles = mesh->triangleList.data();
+	int* uvIndexes = mesh->uvIndexes.data();
+	MeshObject::Normal* cornerNormals = mesh->cornerNormals.data();
+	bool hasUVIndexes = mesh->uvIndexes.size() == mesh->triangleList.size();
+	bool hasCornerNormals = mesh->cornerNormals.size() == mesh->triangleList.size();
+	size_t triangleCount = mesh->triangleList.size() / 3;
+	size_t kept = 0;
+	for (size_t i = 0; i < triangleCount; i++) {
+		uint32_t* tri = &triangles[i * 3];
+		if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0]) continue;
+		memmove(&triangles[kept * 3], tri, 3 * sizeof(uint32_t));
+		if (hasUVIndexes) memmove(&uvIndexes[kept * 3], &uvIndexes[i * 3], 3 * sizeof(int));
+		if (hasCornerNormals) memmove(&cornerNormals[kept * 3], &cornerNormals[i * 3], 3 * sizeof(MeshObject::Normal));
+		kept++;
+	}
+	mesh->triangleList.resize(kept * 3);
+	if (hasUVIndexes) mesh->uvIndexes.resize(kept * 3);
+	if (hasCornerNormals) mesh->cornerNormals.resize(kept * 3);
+	return triangleCount - kept;
+}
+
+size_t VertexWelder::weldVertices(MeshObject* mesh, float epsilon, int threadCount)
+{
+	auto start = Timer::begin();
+	threadCount = Parallel::threadCount(threadCount);
+	size_t vertexCount = mesh->vertices.size();
+	if (vertexCount == 0) return 0;
+	std::vector<uint32_t> remap;
+	const float* positions = &mesh->vertices.data()->x;
+	size_t uniqueCount = buildWeldRemap<3>(positions, sizeof(MeshObject::Vertex) / sizeof(float), vertexCount, epsilon, threadCount, remap);
+	const uint32_t* remapPtr = remap.data();
+
+	std::vector<MeshObject::Vertex> vertices(uniqueCount);
+	MeshObject::Vertex* oldVertices = mesh->vertices.data();
+	for (size_t i = vertexCount; i-- > 0;) {
+		vertices[remapPtr[i]] = oldVertices[i]; // walk backwards so the first vertex of each group wins
+	}
+	mesh->vertices.swap(vertices);
+
+	uint32_t* triangles = mesh->triangleList.data();
+	for (size_t i = 0; i < mesh->triangleList.size(); i++) {
+		triangles[i] = remapPtr[triangles[i]];
+	}
+	size_t degenerateCount = removeDegenerateTriangles(mesh);
+
+	size_t removed = vertexCount - uniqueCount;
+	std::cout << "Welded vertices: " << vertexCount << " -> " << uniqueCount << " (-" << removed << ", "
+		<< (vertexCount ? (float)removed * 100.0f / (float)vertexCount : 0.0f) << "%), removed (" << degenerateCount << ") degenerate triangles" << std::endl;
+	Timer::end(start, "Welded vertices: ");
+	return removed;
+}
+
+size_t VertexWelder::weldUVs(MeshObject* mesh, float epsilon, int threadCount)
+{
+	auto start = Timer::begin();
+	threadCount = Parallel::threadCount(threadCount);
+	size_t uvCount = mesh->uvs.size() / 2;
+	if (uvCount == 0) return 0;
+	std::vector<uint32_t> remap;
+	size_t uniqueCount = buildWeldRemap<2>(mesh->uvs.data(), 2, uvCount, epsilon, threadCount, remap);
+	const uint32_t* remapPtr = remap.data();
+
+	std::vector<float> uvs(uniqueCount * 2);
+	const float* oldUVs = mesh->uvs.data();
+	for (size_t i = uvCount; i-- > 0;) {
+		uvs[remapPtr[i] * 2] = oldUVs[i * 2];
+		uvs[remapPtr[i] * 2 + 1] = oldUVs[i * 2 + 1];
+	}
+	mesh->uvs.swap(uvs);
+
+	int* uvIndexes = mesh->uvIndexes.data();
+	for (size_t i = 0; i < mesh->uvIndexes.size(); i++) {
+		if ((size_t)uvIndexes[i] < uvCount) uvIndexes[i] = (int)remapPtr[uvIndexes[i]];
+	}
+
+	size_t removed = uvCount - uniqueCount;
+	std::cout << "Welded uv coords: " << uvCount << " -> " << uniqueCount << " (-" << removed << ", "
+		<< (uvCount ? (float)removed * 100.0f / (float)uvCount : 0.0f) << "%)" << std::endl;
+	Timer::end(start, "Welded uv coords: ");
+	return removed;
+}
\ No newline at end of file
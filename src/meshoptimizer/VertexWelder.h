@@ -0,0 +1,53 @@
+#ifndef SRC_MESHOPTIMIZER_VERTEXWELDER_H_
+#define SRC_MESHOPTIMIZER_VERTEXWELDER_H_
+
+#include <vector>
+#include <cstdint>
+#include <model/MeshObject.h>
+
+class VertexWelder {
+private:
+	/// <summary>
+	/// <para/>Find values that lie within epsilon of each other, using a hash grid with cells epsilon wide and 64 bit cell coordinates.
+	/// <para/>Cell coordinates and neighbour searches run in parallel. Each value is welded to the lowest index value within epsilon
+	/// of it, found by searching the surrounding 3^Dimensions cells, and chains of welds are resolved in index order,
+	/// so the result doesn't depend on the thread count.
+	/// </summary>
+	/// <param name="values">- first component of the first value</param>
+	/// <param name="stride">- distance between values, in floats</param>
+	/// <param name="count">- number of values</param>
+	/// <param name="epsilon">- weld distance</param>
+	/// <param name="threadCount">- number of threads to use</param>
+	/// <param name="remap">- old index -> new index. New indices keep the order of the first value of each group.</param>
+	/// <returns>Number of unique values</returns>
+	template <int Dimensions>
+	static size_t buildWeldRemap(const float* values, size_t stride, size_t count, float epsilon, int threadCount, std::vector<uint32_t>& remap);
+
+	/// <summary>
+	/// Remove triangles that have two or more corners on the same vertex, along with their uv indexes and corner normals.
+	/// </summary>
+	/// <param name="mesh">- mesh to clean up</param>
+	/// <returns>Number of triangles removed</returns>
+	static size_t removeDegenerateTriangles(MeshObject* mesh);
+public:
+	/// <summary>
+	/// <para/>Merge vertices whose positions are within epsilon of each other, and remap mesh.triangleList to match.
+	/// <para/>Triangles that collapse onto a line are removed.
+	/// </summary>
+	/// <param name="mesh">- mesh to weld in place</param>
+	/// <param name="epsilon">- weld distance</param>
+	/// <param name="threadCount">- number of threads to use, 0 for one per hardware thread</param>
+	/// <returns>Number of vertices removed</returns>
+	static size_t weldVertices(MeshObject* mesh, float epsilon, int threadCount = 0);
+
+	/// <summary>
+	/// Merge uv coords that are within epsilon of each other, and remap mesh.uvIndexes to match.
+	/// </summary>
+	/// <param name="mesh">- mesh to weld in place</param>
+	/// <param name="epsilon">- weld distance</param>
+	/// <param name="threadCount">- number of threads to use, 0 for one per hardware thread</param>
+	/// <returns>Number of uv coords removed</returns>
+	static size_t weldUVs(MeshObject* mesh, float epsilon, int threadCount = 0);
+};
+
+#endif
\ No newline at end of file
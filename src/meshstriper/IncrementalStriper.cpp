@@ -0,0 +1,220 @@
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <utility>
+#include <unordered_map>
+#include <unordered_set>
+#include <meshstriper/IncrementalStriper.h>
+#include <meshstriper/MeshStriper.h>
+#include <util/Timer.hpp>
+
+// Position, normal and uv of a vertex, compared bit for bit. The uv is quantized the way .m files store it.
+struct VertexKey {
+	uint32_t words[7];
+
+	VertexKey(const MeshObject::Vertex& vertex, uint16_t u, uint16_t v)
+	{
+		const float values[6] = { vertex.x, vertex.y, vertex.z, vertex.normal.x, vertex.normal.y, vertex.normal.z };
+		memcpy(words, values, sizeof(values));
+		words[6] = ((uint32_t)u << 16) | v;
+	}
+
+	bool operator==(const VertexKey& other) const { return memcmp(words, other.words, sizeof(words)) == 0; }
+};
+
+struct VertexKeyHash {
+	size_t operator()(const VertexKey& key) const
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (uint32_t word : key.words) hash = (hash ^ word) * 1099511628211ull;
+		return (size_t)hash;
+	}
+};
+
+void IncrementalStriper::splitStrips(const MeshObject& mesh, std::vector<std::vector<uint16_t>>& pieces)
+{
+	// Triangle i of a strip is drawn (s[i + 1], s[i], s[i + 2]) when i is odd
+	auto cut = [&](const uint16_t* s, size_t length) {
+		size_t first = 0;
+		for (size_t i = 0; i + 2 <= length; i++) {
+			bool end = i + 2 == length;
+			if (!end && s[i] != s[i + 1] && s[i + 1] != s[i + 2] && s[i] != s[i + 2]) continue;
+			if (i > first) {
+				pieces.emplace_back();
+				std::vector<uint16_t>& piece = pieces.back();
+				if (first & 1) piece.push_back(s[first]);
+				piece.insert(piece.end(), s + first, s + i + 2);
+			}
+			first = i + 1;
+		}
+	};
+	bool restart = mesh.primitiveType == MeshObject::PrimitiveType::RestartStrip;
+	for (const std::vector<uint16_t>& strip : mesh.triangleStrips) {
+		size_t first = 0;
+		for (size_t i = 0; i <= strip.size(); i++) {
+			if (i < strip.size() && !(restart && strip[i] == MeshObject::stripRestartIndex)) continue;
+			cut(strip.data() + first, i - first);
+			first = i + 1;
+		}
+	}
+}
+
+void IncrementalStriper::matchVertices(const MeshObject& mesh, const MeshObject& previous, std::vector<int>& vertexMap)
+{
+	// .m files store uvs as (uint16_t)(uv * 10000), and read them back divided by 10000, so the previous ones are rounded back
+	bool meshUVs = mesh.uvs.size() == mesh.vertices.size() * 2;
+	bool previousUVs = previous.uvs.size() == previous.vertices.size() * 2;
+	std::unordered_map<VertexKey, int, VertexKeyHash> vertices;
+	vertices.reserve(mesh.vertices.size());
+	for (size_t v = 0; v < mesh.vertices.size(); v++) {
+		uint16_t u = meshUVs ? static_cast<uint16_t>(mesh.uvs[v * 2] * 10000) : 0;
+		uint16_t w = meshUVs ? static_cast<uint16_t>(mesh.uvs[v * 2 + 1] * 10000) : 0;
+		vertices.emplace(VertexKey(mesh.vertices[v], u, w), (int)v);
+	}
+	vertexMap.assign(previous.vertices.size(), -1);
+	for (size_t v = 0; v < previous.vertices.size(); v++) {
+		uint16_t u = previousUVs ? static_cast<uint16_t>(previous.uvs[v * 2] * 10000 + 0.5f) : 0;
+		uint16_t w = previousUVs ? static_cast<uint16_t>(previous.uvs[v * 2 + 1] * 10000 + 0.5f) : 0;
+		auto found = vertices.find(VertexKey(previous.vertices[v], u, w));
+		if (found != vertices.end()) vertexMap[v] = found->second;
+	}
+}
+
+bool IncrementalStriper::restripe(MeshObject* mesh, const MeshObject& previous, const StripOptions& options, StripBackendType backend)
+{
+	if (previous.primitiveType == MeshObject::PrimitiveType::TriangleList || previous.triangleStrips.empty()) return false;
+	if (!previous.uvIndexes.empty() || !mesh->uvIndexes.empty()) return false;
+	if (mesh->vertices.size() > 65536) return false;
+	auto start = Timer::begin();
+	std::vector<int> vertexMap;
+	matchVertices(*mesh, previous, vertexMap);
+
+	// Triangles of the new mesh by their vertices, rotated to start at the smallest one when the backend keeps the winding,
+	// sorted when it doesn't. Equal triangles are chained in index order.
+	bool keepWinding = StripBackend::keepsWinding(backend, options);
+	auto triangleKey = [keepWinding](uint32_t a, uint32_t b, uint32_t c) {
+		if (keepWinding) {
+			while (a > b || a > c) {
+				uint32_t first = a;
+				a = b;
+				b = c;
+				c = first;
+			}
+		} else {
+			if (a > b) std::swap(a, b);
+			if (b > c) std::swap(b, c);
+			if (a > b) std::swap(a, b);
+		}
+		return ((uint64_t)a << 32) | ((uint64_t)b << 16) | c;
+	};
+	// Whether triangle t has the edge a to b, so a triangle with its vertices, starting a, b, has the same winding
+	auto sameWinding = [&](int t, uint32_t a, uint32_t b) {
+		const uint32_t* v = &mesh->triangleList[t * 3];
+		return (v[0] == a && v[1] == b) || (v[1] == a && v[2] == b) || (v[2] == a && v[0] == b);
+	};
+	const uint32_t* triangleList = mesh->triangleList.data();
+	int triangleCount = (int)mesh->triangleList.size() / 3;
+	std::unordered_map<uint64_t, int> firstTriangles;
+	firstTriangles.reserve(triangleCount);
+	std::vector<int> nextTriangles(triangleCount, -1);
+	for (int t = triangleCount - 1; t >= 0; t--) {
+		const uint32_t* v = &triangleList[t * 3];
+		auto inserted = firstTriangles.emplace(triangleKey(v[0], v[1], v[2]), t);
+		if (inserted.second) continue;
+		nextTriangles[t] = inserted.first->second;
+		inserted.first->second = t;
+	}
+
+	// Match the triangles of the previous strips
+	std::vector<std::vector<uint16_t>> pieces;
+	splitStrips(previous, pieces);
+	std::vector<int> pieceTriangles; // matched triangle of every triangle of every piece, -1 if it's gone
+	std::vector<size_t> pieceOffsets(pieces.size() + 1, 0);
+	std::vector<uint8_t> claimed(triangleCount, 0);
+	for (size_t p = 0; p < pieces.size(); p++) {
+		pieceOffsets[p] = pieceTriangles.size();
+		const uint16_t* s = pieces[p].data();
+		// indices come straight from the file, a piece that points past the vertices is treated as gone
+		bool inRange = true;
+		for (size_t i = 0; i < pieces[p].size() && inRange; i++) inRange = s[i] < vertexMap.size();
+		if (!inRange) {
+			pieceTriangles.push_back(-1);
+			continue;
+		}
+		int flipped = -1; // whether the matched triangles of the piece are flipped, -1 before the first one
+		for (size_t i = 0; i + 2 < pieces[p].size(); i++) {
+			if (s[i] == s[i + 1]) continue; // repeated first index of a piece that started on an odd triangle
+			// triangle i of a strip is drawn (s[i + 1], s[i], s[i + 2]) when i is odd
+			int v0 = vertexMap[s[i + (i & 1)]];
+			int v1 = vertexMap[s[i + 1 - (i & 1)]];
+			int v2 = vertexMap[s[i + 2]];
+			int matched = -1;
+			if (v0 != -1 && v1 != -1 && v2 != -1) {
+				auto found = firstTriangles.find(triangleKey(v0, v1, v2));
+				if (found != firstTriangles.end() && found->second != -1) {
+					// a piece that is flipped in places had some of its triangles flipped since, those count as new
+					int isFlipped = sameWinding(found->second, v0, v1) ? 0 : 1;
+					if (flipped == -1) flipped = isFlipped;
+					if (isFlipped == flipped) {
+						matched = found->second;
+						found->second = nextTriangles[matched];
+						claimed[matched] = 1;
+					}
+				}
+			}
+			pieceTriangles.push_back(matched);
+		}
+	}
+	pieceOffsets[pieces.size()] = pieceTriangles.size();
+
+	// A piece is dropped when one of its triangles is gone or it borders a new triangle, so the new triangles can join its strip
+	std::unordered_set<uint32_t> addedEdges;
+	for (int t = 0; t < triangleCount; t++) {
+		if (claimed[t]) continue;
+		for (int k = 0; k < 3; k++) {
+			uint32_t a = triangleList[t * 3 + k];
+			uint32_t b = triangleList[t * 3 + (k + 1) % 3];
+			addedEdges.insert(a < b ? (a << 16) | b : (b << 16) | a);
+		}
+	}
+	std::vector<std::vector<uint16_t>> strips;
+	for (size_t p = 0; p < pieces.size(); p++) {
+		bool keep = true;
+		for (size_t j = pieceOffsets[p]; j < pieceOffsets[p + 1] && keep; j++) {
+			int t = pieceTriangles[j];
+			keep = t != -1;
+			for (int k = 0; k < 3 && keep; k++) {
+				uint32_t a = triangleList[t * 3 + k];
+				uint32_t b = triangleList[t * 3 + (k + 1) % 3];
+				keep = addedEdges.count(a < b ? (a << 16) | b : (b << 16) | a) == 0;
+			}
+		}
+		if (!keep) {
+			for (size_t j = pieceOffsets[p]; j < pieceOffsets[p + 1]; j++) {
+				if (pieceTriangles[j] != -1) claimed[pieceTriangles[j]] = 0;
+			}
+			continue;
+		}
+		strips.emplace_back(pieces[p].size());
+		for (size_t i = 0; i < pieces[p].size(); i++) strips.back()[i] = (uint16_t)vertexMap[pieces[p][i]];
+	}
+	size_t keptCount = strips.size();
+
+	MeshObject region;
+	for (int t = 0; t < triangleCount; t++) {
+		if (!claimed[t]) region.triangleList.insert(region.triangleList.end(), triangleList + t * 3, triangleList + t * 3 + 3);
+	}
+	size_t regionTriangles = region.triangleList.size() / 3;
+	if (regionTriangles > 0) {
+		if (!StripBackend::create(backend, options)->striper(&region)) StripBackend::create(StripBackendType::MeshStriper, options)->striper(&region);
+		for (std::vector<uint16_t>& strip : region.triangleStrips) strips.push_back(std::move(strip));
+	}
+
+	std::cout << "Kept (" << keptCount << ") of (" << pieces.size() << ") previous strips, restriped (" << regionTriangles << ") triangles into ("
+		<< strips.size() - keptCount << ") strips" << std::endl;
+	mesh->triangleStrips.swap(strips);
+	mesh->primitiveType = MeshObject::PrimitiveType::TriangleStrips;
+	mesh->triangleList.clear();
+	Timer::end(start, "Incrementally striped (" + std::to_string(triangleCount) + ") triangles: ");
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef SRC_MESHSTRIPER_INCREMENTALSTRIPER_H_
+#define SRC_MESHSTRIPER_INCREMENTALSTRIPER_H_
+
+#include <vector>
+#include <cstdint>
+#include <model/MeshObject.h>
+#include <meshstriper/StripBackend.h>
+
+/// <summary>
+/// <para/>Re-strips a mesh that was converted before, keeping the strips of the previous .m file wherever the mesh didn't change.
+/// <para/>Vertices are matched by position, normal and uv, and triangles by their matched vertices. A previous strip
+/// is kept as it is unless one of its triangles is gone, or it shares an edge with a triangle that is new. Only the new
+/// triangles and the triangles of the dropped strips are striped again, with the backend the previous strips came from.
+/// <para/>If that backend keeps the winding, triangles match only with the same winding, so a flipped triangle counts as new.
+/// Otherwise a strip is also dropped when some of its triangles are flipped and others aren't.
+/// <para/>Stitched strips are split back up at their degenerate triangles and restart indices first. A strip made by
+/// treestriper is split at its swaps too.
+/// </summary>
+class IncrementalStriper {
+private:
+	/// <summary>
+	/// <para/>Cut the strips of a mesh into pieces with no degenerate triangles or restart indices.
+	/// <para/>Pieces that start on an odd triangle of their strip get the first index repeated, so their triangles keep their winding.
+	/// </summary>
+	/// <param name="mesh">- mesh read from a .m file</param>
+	/// <param name="pieces">- strips without degenerate triangles</param>
+	static void splitStrips(const MeshObject& mesh, std::vector<std::vector<uint16_t>>& pieces);
+
+	/// <summary>
+	/// Vertex of mesh with the same position, normal and uv as each vertex of previous, or -1 if there is none.
+	/// </summary>
+	/// <param name="mesh">- new mesh, with split vertices</param>
+	/// <param name="previous">- mesh read from a .m file</param>
+	/// <param name="vertexMap">- matching vertex of mesh for each vertex of previous</param>
+	static void matchVertices(const MeshObject& mesh, const MeshObject& previous, std::vector<int>& vertexMap);
+public:
+	/// <summary>
+	/// <para/>Strip the triangle list of mesh, reusing the strips of previous where the triangles are the same.
+	/// <para/>The strips are stored in mesh.triangleStrips, kept strips first in their previous order, and the triangle list is cleared.
+	/// </summary>
+	/// <param name="mesh">- mesh with a triangle list and split vertices, to put triangle strips into</param>
+	/// <param name="previous">- mesh read from the .m file converted from an earlier version of the same model</param>
+	/// <param name="options">- settings for the strip backend</param>
+	/// <param name="backend">- backend previous was striped with, and the new triangles are striped with. MeshStriper is used if it fails.</param>
+	/// <returns>False if previous has no strips, either mesh has separate uv indexes, or mesh has more than 65536 vertices,
+	/// which the 16 bit triangle and edge keys can't tell apart. The mesh is left untouched.</returns>
+	static bool restripe(MeshObject* mesh, const MeshObject& previous, const StripOptions& options, StripBackendType backend = StripBackendType::MeshStriper);
+};
+
+#endif
\ No newline at end of file
@@ -1,17 +1,22 @@
 #include <string>
+#include <cstring>
 #include <numeric>
 #include <algorithm>
 #include <immintrin.h>
 #include <meshstriper/MeshStriper.h>
-#include <meshstriper/Sorter.h>
+#include <meshstriper/StripTunneler.h>
+#include <meshoptimizer/CacheOptimizer.h>
+#include <util/BucketQueue.hpp>
+#include <util/CpuFeatures.hpp>
+#include <util/Parallel.hpp>
 #include <util/Timer.hpp>
 #include <util/ProgressBar.hpp>
 
-void AdjTriangle::createEdges(int* vertices, int vertexIndex)
+void AdjTriangle::createEdges(const uint32_t* vertices, int vertexIndex)
 {
-	int v1 = vertices[vertexIndex];
-	int v2 = vertices[vertexIndex + 1];
-	int v3 = vertices[vertexIndex + 2];
+	uint32_t v1 = vertices[vertexIndex];
+	uint32_t v2 = vertices[vertexIndex + 1];
+	uint32_t v3 = vertices[vertexIndex + 2];
 	this->vertices[0] = v1;
 	this->vertices[1] = v2;
 	this->vertices[2] = v3;
@@ -48,23 +53,23 @@ void AdjTriangle::createEdges(int* vertices, int vertexIndex)
 	}
 }
 
-int AdjTriangle::getEdgeIndex(uint16_t v1, uint16_t v2)
+int AdjTriangle::getEdgeIndex(uint16_t v1, uint16_t v2) const
 {
-	Edge* e0 = &edges[0];
+	const Edge* e0 = &edges[0];
 	if (v1 == e0->v1 && v2 == e0->v2) return 0;
-	Edge* e1 = &edges[1];
+	const Edge* e1 = &edges[1];
 	if (v1 == e1->v1 && v2 == e1->v2) return 1;
 	return 2;
 }
 
-int AdjTriangle::getEdgeIndex(uint32_t edge)
+int AdjTriangle::getEdgeIndex(uint32_t edge) const
 {
 	if (edges[0].edge == edge) return 0;
 	if (edges[1].edge == edge) return 1;
 	return 2;
 }
 
-uint16_t AdjTriangle::getOppositeVertex(uint16_t v1, uint16_t v2)
+uint16_t AdjTriangle::getOppositeVertex(uint16_t v1, uint16_t v2) const
 {
 	if (v1 == vertices[0]) {
 		if (v2 == vertices[1]) return vertices[2];
@@ -80,30 +85,100 @@ uint16_t AdjTriangle::getOppositeVertex(uint16_t v1, uint16_t v2)
 	}
 }
 
-void MeshStriper::createTriangleStructures(std::vector<AdjTriangle>& adjacencies, int* vertices)
+void CompactAdjacency::build(const std::vector<AdjTriangle>& triangles, int threadCount)
+{
+	size_t numTriangles = triangles.size();
+	vertices.resize(numTriangles * 3);
+	links.resize(numTriangles * 3);
+	const AdjTriangle* trianglePtr = triangles.data();
+	uint16_t* verticesPtr = vertices.data();
+	uint32_t* linksPtr = links.data();
+	Parallel::forRange(numTriangles, threadCount, [&](size_t begin, size_t end, int) {
+		for (size_t t = begin; t < end; t++) {
+			const AdjTriangle& triangle = trianglePtr[t];
+			for (int k = 0; k < 3; k++) {
+				verticesPtr[t * 3 + k] = triangle.vertices[k];
+				int adjacent = triangle.adjacentTris[k];
+				// Found by the edge rather than by the link back, two triangles can share more than one edge
+				linksPtr[t * 3 + k] = adjacent == -1 ? noLink
+					: (uint32_t)adjacent | ((uint32_t)trianglePtr[adjacent].getEdgeIndex(triangle.edges[k].edge) << 30);
+			}
+		}
+	}, Parallel::itemGrain);
+}
+
+void MeshStriper::createTriangleStructures(std::vector<AdjTriangle>& adjacencies, const uint32_t* vertices)
 {
 #if _DEBUG
 	auto start = Timer::begin();
 #endif
 
-	AdjTriangle* adjacencyPtr = adjacencies.data();
-	int numAdjacencies = adjacencies.size();
-	int remaining = numAdjacencies % 4;
-	for (int i = 0; i < numAdjacencies; i += 4) {
-		adjacencyPtr[i].createEdges(vertices, i * 3);
-		adjacencyPtr[i+1].createEdges(vertices, (i+1) * 3);
-		adjacencyPtr[i+2].createEdges(vertices, (i+2) * 3);
-		adjacencyPtr[i+3].createEdges(vertices, (i+3) * 3);
-	}
-	for (int i = numAdjacencies - remaining; i < numAdjacencies; i++) {
-		adjacencyPtr[i].createEdges(vertices, i * 3);
-	}
+	createEdges(adjacencies.data(), vertices, 0, adjacencies.size());
 
 #if _DEBUG
 	Timer::end(start, "Created adjacencies: ");
 #endif
 }
 
+// Blend mask that picks every third of 8 lanes, starting from the lane bit in first
+#define BLEND_MASK(first) ((first) | (first) << 3 | ((first) << 6 & 0xFF))
+
+CPU_TARGET("avx2")
+size_t MeshStriper::createEdgesAVX2(AdjTriangle* triangles, const uint32_t* vertices, size_t begin, size_t end)
+{
+	static_assert(sizeof(Edge) == 8, "Edges are written as one 64 bit word");
+	const __m256i firstOrder = _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5);
+	const __m256i secondOrder = _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6);
+	const __m256i thirdOrder = _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7);
+	alignas(32) uint64_t edgeWords[3][8];
+	size_t t = begin;
+	for (; t + 8 <= end; t += 8) {
+		// a0 b0 c0 a1 b1 c1 a2 b2 | c2 a3 b3 c3 a4 b4 c4 a5 | b5 c5 a6 b6 c6 a7 b7 c7
+		const uint32_t* source = vertices + t * 3;
+		__m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source));
+		__m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + 8));
+		__m256i x2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + 16));
+		__m256i a = _mm256_blend_epi32(_mm256_blend_epi32(x0, x1, BLEND_MASK(0x2)), x2, BLEND_MASK(0x4));
+		__m256i b = _mm256_blend_epi32(_mm256_blend_epi32(x0, x1, BLEND_MASK(0x4)), x2, BLEND_MASK(0x1));
+		__m256i c = _mm256_blend_epi32(_mm256_blend_epi32(x0, x1, BLEND_MASK(0x1)), x2, BLEND_MASK(0x2));
+		a = _mm256_permutevar8x32_epi32(a, firstOrder);
+		b = _mm256_permutevar8x32_epi32(b, secondOrder);
+		c = _mm256_permutevar8x32_epi32(c, thirdOrder);
+
+		const __m256i* corners[3][2] = { { &a, &b }, { &b, &c }, { &c, &a } };
+		for (int k = 0; k < 3; k++) {
+			__m256i low = _mm256_min_epu32(*corners[k][0], *corners[k][1]);
+			__m256i high = _mm256_max_epu32(*corners[k][0], *corners[k][1]);
+			// Edge is v1, v2 as 16 bit words followed by the (v1 << 16) | v2 key
+			__m256i pair = _mm256_or_si256(low, _mm256_slli_epi32(high, 16));
+			__m256i key = _mm256_or_si256(_mm256_slli_epi32(low, 16), high);
+			__m256i words0 = _mm256_unpacklo_epi32(pair, key); // triangles 0, 1, 4, 5
+			__m256i words1 = _mm256_unpackhi_epi32(pair, key); // triangles 2, 3, 6, 7
+			_mm256_store_si256(reinterpret_cast<__m256i*>(edgeWords[k]), _mm256_permute2x128_si256(words0, words1, 0x20));
+			_mm256_store_si256(reinterpret_cast<__m256i*>(edgeWords[k] + 4), _mm256_permute2x128_si256(words0, words1, 0x31));
+		}
+
+		for (int i = 0; i < 8; i++) {
+			AdjTriangle& triangle = triangles[t + i];
+			memcpy(&triangle.edges[0], &edgeWords[0][i], sizeof(Edge));
+			memcpy(&triangle.edges[1], &edgeWords[1][i], sizeof(Edge));
+			memcpy(&triangle.edges[2], &edgeWords[2][i], sizeof(Edge));
+			triangle.vertices[0] = (uint16_t)source[i * 3];
+			triangle.vertices[1] = (uint16_t)source[i * 3 + 1];
+			triangle.vertices[2] = (uint16_t)source[i * 3 + 2];
+		}
+	}
+	return t;
+}
+
+#undef BLEND_MASK
+
+void MeshStriper::createEdges(AdjTriangle* triangles, const uint32_t* vertices, size_t begin, size_t end)
+{
+	size_t first = CpuFeatures::hasAVX2() ? createEdgesAVX2(triangles, vertices, begin, end) : begin;
+	for (size_t i = first; i < end; i++) triangles[i].createEdges(vertices, (int)i * 3);
+}
+
 void MeshStriper::updateLink(AdjTriangle* triangles, int firstTri, int secondTri, uint16_t vertex0, uint16_t vertex1)
 {
 	AdjTriangle* tri0 = &triangles[firstTri];
@@ -131,55 +206,59 @@ void MeshStriper::linkTriangleStructures(std::vector<AdjTriangle>& adjacencies)
 #endif
 
 	int edgeCount = (int)adjacencies.size() * 3;
-	std::vector<int> faceIndices(edgeCount); // every edge has an associated face
-	std::vector<uint16_t> firstVertices(edgeCount);
-	std::vector<uint16_t> secondVertices(edgeCount);
+	if (edgeBuffers.empty()) edgeBuffers.resize(1);
+	EdgeSortBuffers& buffers = edgeBuffers[0];
+	buffers.faceIndices.resize(edgeCount); // every edge has an associated face
+	buffers.edgeKeys.resize(edgeCount);
 
 	AdjTriangle* adjacencyPtr = adjacencies.data();
-	int* faceIndicesPtr = faceIndices.data();
-	uint16_t* firstVerticesPtr = firstVertices.data();
-	uint16_t* secondVerticesPtr = secondVertices.data();
+	int* faceIndicesPtr = buffers.faceIndices.data();
+	uint32_t* edgeKeysPtr = buffers.edgeKeys.data();
 
 	for (int i = 0; i < adjacencies.size(); i++) {
 		int edgeIndex = i * 3;
 		faceIndicesPtr[edgeIndex] = i;
 		faceIndicesPtr[edgeIndex + 1] = i;
 		faceIndicesPtr[edgeIndex + 2] = i;
-		AdjTriangle* triangle = &adjacencyPtr[i];
-		Edge* edges = triangle->edges;
-		firstVerticesPtr[edgeIndex] = edges[0].v1;
-		firstVerticesPtr[edgeIndex + 1] = edges[1].v1;
-		firstVerticesPtr[edgeIndex + 2] = edges[2].v1;
-		secondVerticesPtr[edgeIndex] = edges[0].v2;
-		secondVerticesPtr[edgeIndex + 1] = edges[1].v2;
-		secondVerticesPtr[edgeIndex + 2] = edges[2].v2;
+		Edge* edges = adjacencyPtr[i].edges;
+		edgeKeysPtr[edgeIndex] = edges[0].edge;
+		edgeKeysPtr[edgeIndex + 1] = edges[1].edge;
+		edgeKeysPtr[edgeIndex + 2] = edges[2].edge;
 	}
+#if _DEBUG
+	int memoryUsage = linkSortedEdges(adjacencyPtr, buffers);
+	memoryUsage += edgeCount * sizeof(int);
+	memoryUsage += edgeCount * sizeof(uint32_t);
+	std::cout << "Linking memory usage: " << memoryUsage << " bytes\n";
+	Timer::end(start, "Linked adjacencies: ");
+#else
+	linkSortedEdges(adjacencyPtr, buffers);
+#endif
+}
+
+int MeshStriper::linkSortedEdges(AdjTriangle* adjacencyPtr, EdgeSortBuffers& buffers)
+{
+	int edgeCount = (int)buffers.faceIndices.size();
+	if (edgeCount == 0) return 0;
 
-	//Sort the edges by first vertex then second vertex, ensuring that adjacent edges are next to each other
-	Sorter sorter;
-	std::vector<int> firstSortedIndices(edgeCount);
-	std::vector<int> secondSortedIndices(edgeCount);
-	sorter.sortFast(firstVertices, firstSortedIndices);
-	sorter.sortFast(secondVertices, firstSortedIndices, secondSortedIndices);
-
-	// Read the list in sorted order, creating links between adjacent triangles
-	int* sortedIndicesPtr = secondSortedIndices.data();
-	int sortedIndex = sortedIndicesPtr[0];
-	uint16_t lastVertex0 = firstVerticesPtr[sortedIndex];
-	uint16_t lastVertex1 = secondVerticesPtr[sortedIndex];
-	uint32_t combinedLastVertex = (lastVertex0 << 16) | lastVertex1;
-	char count = 0;
+	// Sort the edges with their faces, so the copies of a shared edge are next to each other
+	int memoryUsage = 0;
+	buffers.sorter.sortPairs(buffers.edgeKeys, buffers.faceIndices, &memoryUsage);
+
+	// Read the edges in sorted order, creating links between adjacent triangles
+	const uint32_t* edgeKeysPtr = buffers.edgeKeys.data();
+	const int* faceIndicesPtr = buffers.faceIndices.data();
+	uint32_t combinedLastVertex = edgeKeysPtr[0];
+	int count = 0;
 	int faces[2];
 
 	for (int i = 0; i < edgeCount; i++) {
-		sortedIndex = sortedIndicesPtr[i];
-		int faceIndex = faceIndicesPtr[sortedIndex];
-		uint16_t vertex0 = firstVerticesPtr[sortedIndex];
-		uint16_t vertex1 = secondVerticesPtr[sortedIndex];
-		uint32_t combinedCurrentVertex = (vertex0 << 16) | vertex1;
+		int faceIndex = faceIndicesPtr[i];
+		uint32_t combinedCurrentVertex = edgeKeysPtr[i];
 		if (combinedCurrentVertex == combinedLastVertex) {
-			faces[count] = faceIndex;
-			count++;
+			// a third copy means a non-manifold edge, which isn't linked. count stops at 3, so no number of copies links it again.
+			if (count < 2) faces[count] = faceIndex;
+			if (count < 3) count++;
 		}
 		else {
 			if (count == 2) updateLink(adjacencyPtr, faces[0], faces[1], combinedLastVertex);
@@ -190,114 +269,589 @@ void MeshStriper::linkTriangleStructures(std::vector<AdjTriangle>& adjacencies)
 		}
 	}
 	if (count == 2) updateLink(adjacencyPtr, faces[0], faces[1], combinedLastVertex);
+	return memoryUsage;
+}
 
+void MeshStriper::hashTriangleStructures(std::vector<AdjTriangle>& adjacencies)
+{
 #if _DEBUG
-	int memoryUsage = 0;
-	memoryUsage += edgeCount * sizeof(int);
-	memoryUsage += edgeCount * sizeof(uint16_t);
-	memoryUsage += edgeCount * sizeof(uint16_t);
-	memoryUsage += edgeCount * sizeof(int);
-	memoryUsage += edgeCount * sizeof(int);
+	auto start = Timer::begin();
+	size_t memoryUsage = hashEdges(adjacencies.data(), nullptr, (int)adjacencies.size() * 3);
 	std::cout << "Linking memory usage: " << memoryUsage << " bytes\n";
-	Timer::end(start, "Linked adjacencies: ");
+	Timer::end(start, "Linked adjacencies by hashing: ");
+#else
+	hashEdges(adjacencies.data(), nullptr, (int)adjacencies.size() * 3);
 #endif
 }
 
-void MeshStriper::generateStrips(std::vector<AdjTriangle>& adjacencies, int numTriangles, std::vector<std::vector<uint16_t>>& strips)
+size_t MeshStriper::hashEdges(AdjTriangle* adjacencyPtr, const int* edgeList, int edgeCount)
+{
+	struct EdgeSlot {
+		uint32_t edge;
+		int firstFace; // -1 for an empty slot
+		int secondFace; // -1 until a second triangle shares the edge, -2 once a third one does
+	};
+	// at least 2 slots per edge, so the load factor stays at or below 0.5 when most edges aren't shared, as in triangle soups
+	int tableBits = 1;
+	while (((size_t)1 << tableBits) < (size_t)edgeCount * 2) tableBits++;
+	uint32_t mask = (1u << tableBits) - 1;
+	std::vector<EdgeSlot> table((size_t)1 << tableBits, EdgeSlot{ 0, -1, -1 });
+	EdgeSlot* tablePtr = table.data();
+
+	for (int e = 0; e < edgeCount; e++) {
+		int edgeIndex = edgeList ? edgeList[e] : e;
+		int i = edgeIndex / 3;
+		uint32_t edge = adjacencyPtr[i].edges[edgeIndex % 3].edge;
+		// Fibonacci hashing spreads the packed vertex pairs over the high bits
+		uint32_t slot = (edge * 2654435769u) >> (32 - tableBits);
+		while (tablePtr[slot].firstFace != -1 && tablePtr[slot].edge != edge) slot = (slot + 1) & mask;
+		EdgeSlot* entry = &tablePtr[slot];
+		if (entry->firstFace == -1) {
+			entry->edge = edge;
+			entry->firstFace = i;
+		}
+		else if (entry->secondFace == -1) {
+			entry->secondFace = i;
+			updateLink(adjacencyPtr, entry->firstFace, i, edge);
+		}
+		else if (entry->secondFace >= 0) {
+			// Non-manifold edge, undo the link
+			AdjTriangle* first = &adjacencyPtr[entry->firstFace];
+			AdjTriangle* second = &adjacencyPtr[entry->secondFace];
+			first->adjacentTris[first->getEdgeIndex(edge)] = -1;
+			second->adjacentTris[second->getEdgeIndex(edge)] = -1;
+			entry->secondFace = -2;
+		}
+	}
+	return table.size() * sizeof(EdgeSlot);
+}
+
+void MeshStriper::linkTriangleStructuresParallel(std::vector<AdjTriangle>& adjacencies, const uint32_t* vertices, bool hashed)
 {
+#if _DEBUG
 	auto start = Timer::begin();
-	std::vector<int> indices(numTriangles);
-	std::iota(indices.begin(), indices.end(), 0);
-	int remainingTriangles = numTriangles;
-	AdjTriangle* triangles = adjacencies.data();
-	int* indicesPtr = indices.data();
-	ProgressBar progressBar(numTriangles);
-	progressBar.start();
+#endif
+
+	int threadCount = options.threadCount;
+	int numTriangles = (int)adjacencies.size();
+	AdjTriangle* adjacencyPtr = adjacencies.data();
+	Parallel::forRange(numTriangles, threadCount, [&](size_t begin, size_t end, int) {
+		createEdges(adjacencyPtr, vertices, begin, end);
+	}, Parallel::itemGrain);
+
+	// Bucket the edges by the range their smaller vertex falls in. Both copies of a shared edge land in the same partition,
+	// so every partition links its own edges, and no two threads write the same link.
+	int vertexRange = 1;
+	for (int i = 0; i < numTriangles * 3; i++) vertexRange = std::max(vertexRange, (int)vertices[i] + 1);
+	int partitionCount = threadCount;
+	auto partitionOf = [&](const Edge& edge) {
+		return (int)((int64_t)edge.v1 * partitionCount / vertexRange);
+	};
+	// Count per thread and partition, then scatter, so each partition keeps its edges in triangle order
+	std::vector<int> counts((size_t)threadCount * partitionCount, 0);
+	Parallel::forRange(numTriangles, threadCount, [&](size_t begin, size_t end, int thread) {
+		int* threadCounts = &counts[(size_t)thread * partitionCount];
+		for (size_t i = begin; i < end; i++) {
+			for (int k = 0; k < 3; k++) threadCounts[partitionOf(adjacencyPtr[i].edges[k])]++;
+		}
+	}, Parallel::itemGrain);
+	std::vector<int> partitionOffsets(partitionCount + 1, 0);
+	std::vector<int> writeOffsets(counts.size());
+	int offset = 0;
+	for (int p = 0; p < partitionCount; p++) {
+		partitionOffsets[p] = offset;
+		for (int t = 0; t < threadCount; t++) {
+			writeOffsets[(size_t)t * partitionCount + p] = offset;
+			offset += counts[(size_t)t * partitionCount + p];
+		}
+	}
+	partitionOffsets[partitionCount] = offset;
+	std::vector<int> partitionEdges((size_t)numTriangles * 3);
+	Parallel::forRange(numTriangles, threadCount, [&](size_t begin, size_t end, int thread) {
+		int* threadOffsets = &writeOffsets[(size_t)thread * partitionCount];
+		for (size_t i = begin; i < end; i++) {
+			for (int k = 0; k < 3; k++) partitionEdges[threadOffsets[partitionOf(adjacencyPtr[i].edges[k])]++] = (int)i * 3 + k;
+		}
+	}, Parallel::itemGrain);
 
+	if (!hashed && (int)edgeBuffers.size() < threadCount) edgeBuffers.resize(threadCount);
+	Parallel::forRange(partitionCount, threadCount, [&](size_t begin, size_t end, int thread) {
+		for (size_t p = begin; p < end; p++) {
+			const int* edgeList = &partitionEdges[partitionOffsets[p]];
+			int edgeCount = partitionOffsets[p + 1] - partitionOffsets[p];
+			if (hashed) {
+				hashEdges(adjacencyPtr, edgeList, edgeCount);
+				continue;
+			}
+			EdgeSortBuffers& buffers = edgeBuffers[thread];
+			buffers.faceIndices.resize(edgeCount);
+			buffers.edgeKeys.resize(edgeCount);
+			for (int e = 0; e < edgeCount; e++) {
+				buffers.faceIndices[e] = edgeList[e] / 3;
+				buffers.edgeKeys[e] = adjacencyPtr[edgeList[e] / 3].edges[edgeList[e] % 3].edge;
+			}
+			linkSortedEdges(adjacencyPtr, buffers);
+		}
+	});
+
+#if _DEBUG
+	Timer::end(start, "Linked adjacencies in (" + std::to_string(partitionCount) + ") partitions: ");
+#endif
+}
+
+void MeshStriper::walkStrips(const CompactAdjacency& triangles, const int* startTriangles, int startCount, const int* regions, int region, uint8_t* used, int* positions,
+	std::vector<std::vector<uint16_t>>& strips, std::vector<uint8_t>* blockedStrips, std::vector<int>* stripTriangles, ProgressBar* progressBar)
+{
+	// A triangle can join the strip if it exists, hasn't been used, and belongs to the region being striped
+	auto available = [&](int triangle) {
+		return triangle != -1 && (regions == nullptr || regions[triangle] == region) && !used[triangle];
+	};
+	// Start triangles that aren't used yet, keyed by their number of available neighbours.
+	// Pushed backwards so that ties come out in startTriangles order.
+	bool leastConnectedFirst = options.leastConnectedFirst;
+	BucketQueue startQueue;
+	if (leastConnectedFirst) {
+		startQueue.reset(startCount, 3);
+		for (int i = 0; i < startCount; i++) positions[startTriangles[i]] = i;
+		for (int i = startCount - 1; i >= 0; i--) {
+			int triangle = startTriangles[i];
+			if (used[triangle]) continue;
+			startQueue.push(i, available(triangles.getNeighbour(triangle, 0)) + available(triangles.getNeighbour(triangle, 1))
+				+ available(triangles.getNeighbour(triangle, 2)));
+		}
+	}
+	auto take = [&](int triangle) {
+		used[triangle] = 1;
+		if (stripTriangles) stripTriangles->push_back(triangle);
+		if (!leastConnectedFirst) return;
+		if (startQueue.contains(positions[triangle])) startQueue.remove(positions[triangle]);
+		for (int k = 0; k < 3; k++) {
+			int adjacent = triangles.getNeighbour(triangle, k);
+			if (!available(adjacent)) continue;
+			int position = positions[adjacent];
+			if (startQueue.contains(position)) startQueue.changeKey(position, startQueue.key(position) - 1);
+		}
+	};
+	// Next to a triangle of another region, so the strip might continue there
+	auto blocked = [&](int triangle) {
+		return triangle != -1 && regions != nullptr && regions[triangle] != region;
+	};
+
+	int usedCount = 0;
 	int lastTriangleIndex = 0;
-	while (remainingTriangles > 0) {
-		strips.emplace_back();
-		std::vector<uint16_t>* strip = &strips.back();
-		strip->resize(3);
-		uint16_t* stripData = strip->data();
+	while (true) {
 		int nextTriangleIndex = -1;
-		for (int i = lastTriangleIndex; i < numTriangles; i++) {
-			if (indicesPtr[i] != -1) {
-				nextTriangleIndex = i;
-				lastTriangleIndex = i + 1;
-				break;
+		if (leastConnectedFirst) {
+			nextTriangleIndex = startQueue.popMin();
+		}
+		else {
+			for (int i = lastTriangleIndex; i < startCount; i++) {
+				if (!used[startTriangles[i]]) {
+					nextTriangleIndex = i;
+					lastTriangleIndex = i + 1;
+					break;
+				}
 			}
 		}
-		AdjTriangle* firstTri = &triangles[indicesPtr[nextTriangleIndex]];
-		AdjTriangle* currentFrontTri = firstTri;
-		AdjTriangle* currentBackTri = firstTri;
-		indicesPtr[nextTriangleIndex] = -1;
-		remainingTriangles--;
-		memcpy(stripData, firstTri->vertices, 3 * sizeof(uint16_t)); // move current triangle vertices into start of strip
-		uint16_t firstVertex = stripData[0];
-		uint16_t secondVertex = stripData[1];
-		uint16_t thirdVertex = stripData[2];
-		uint16_t secondVertexOld = secondVertex;
+		if (nextTriangleIndex == -1) break;
+		strips.emplace_back();
+		std::vector<uint16_t>* strip = &strips.back();
+		bool isBlocked = false;
+		int firstTri = startTriangles[nextTriangleIndex];
+		take(firstTri);
+		usedCount++;
+		const uint16_t* firstVertices = triangles.getVertices(firstTri);
+		strip->assign(firstVertices, firstVertices + 3); // move current triangle vertices into start of strip
+		uint16_t firstVertex = firstVertices[0];
+		uint16_t lastVertex = firstVertices[2];
+		// The strip grows forwards over the edge between its last 2 vertices, and backwards over the edge between its first 2
+		int frontTri = firstTri;
+		int frontEdge = 1;
+		int backTri = firstTri;
+		int backEdge = 0;
 		while (true) {
-			int frontEdgeIndex;
-			if (secondVertex < thirdVertex) frontEdgeIndex = currentFrontTri->getEdgeIndex(secondVertex, thirdVertex);
-			else frontEdgeIndex = currentFrontTri->getEdgeIndex(thirdVertex, secondVertex);
-			int adjacentTriIndex = currentFrontTri->adjacentTris[frontEdgeIndex];
-			if (indicesPtr[adjacentTriIndex] != -1) {
-				indicesPtr[adjacentTriIndex] = -1;
-				remainingTriangles--;
-				AdjTriangle* adjacentTri = &triangles[adjacentTriIndex];
-				currentFrontTri = adjacentTri;
-				uint16_t newVertex = adjacentTri->getOppositeVertex(secondVertex, thirdVertex);
+			uint32_t link = triangles.getLink(frontTri, frontEdge);
+			int adjacentTriIndex = CompactAdjacency::getLinkedTriangle(link);
+			if (available(adjacentTriIndex)) {
+				take(adjacentTriIndex);
+				usedCount++;
+				int entryEdge = CompactAdjacency::getCounterpartEdge(link);
+				uint16_t newVertex = triangles.getOppositeVertex(adjacentTriIndex, entryEdge);
 				strip->emplace_back(newVertex);
-				secondVertex = thirdVertex;
-				secondVertexOld = secondVertex;
-				thirdVertex = newVertex;
+				frontEdge = triangles.getNextEdge(adjacentTriIndex, entryEdge, lastVertex);
+				frontTri = adjacentTriIndex;
+				lastVertex = newVertex;
 				continue;
 			}
+			isBlocked |= blocked(adjacentTriIndex);
+			link = triangles.getLink(backTri, backEdge);
+			adjacentTriIndex = CompactAdjacency::getLinkedTriangle(link);
+			if (!available(adjacentTriIndex)) { // boundary edge, already used, or another region
+				isBlocked |= blocked(adjacentTriIndex);
+				break;
+			}
+			take(adjacentTriIndex);
+			usedCount++;
+			int entryEdge = CompactAdjacency::getCounterpartEdge(link);
+			uint16_t newVertex = triangles.getOppositeVertex(adjacentTriIndex, entryEdge);
+			strip->insert(strip->begin(), newVertex);
+			backEdge = triangles.getNextEdge(adjacentTriIndex, entryEdge, firstVertex);
+			backTri = adjacentTriIndex;
+			firstVertex = newVertex;
+		}
+		if (blockedStrips) blockedStrips->push_back(isBlocked);
+		if (progressBar) progressBar->updateProgress(usedCount);
+	}
+}
+
+void MeshStriper::generateStrips(const CompactAdjacency& triangles, int numTriangles, std::vector<std::vector<uint16_t>>& strips)
+{
+	auto start = Timer::begin();
+	std::vector<int> startTriangles(numTriangles);
+	std::iota(startTriangles.begin(), startTriangles.end(), 0);
+	std::vector<uint8_t> used(numTriangles, 0);
+	std::vector<int> positions(numTriangles);
+	ProgressBar progressBar(numTriangles);
+	progressBar.start();
+	walkStrips(triangles, startTriangles.data(), numTriangles, nullptr, 0, used.data(), positions.data(), strips, nullptr, nullptr, &progressBar);
+	Timer::end(start, "Found (" + std::to_string(strips.size()) + ") triangle strips: ");
+}
+
+// FIFO post-transform cache, simulated the same way as CacheOptimizer::simulateFIFO
+struct StripCache {
+	std::vector<size_t> loadedAt; // clock when each vertex was last loaded
+	std::vector<int> ring; // the last size vertices loaded, which is what the cache holds
+	std::vector<int> stamps; // last countMisses call that loaded each vertex
+	std::vector<size_t> stampedLoadedAt;
+	size_t clock;
+	size_t size;
+	int stamp = 0;
+
+	StripCache(size_t vertexCount, int size) : loadedAt(vertexCount, 0), ring(size, -1), stamps(vertexCount, 0), stampedLoadedAt(vertexCount, 0),
+		clock((size_t)size + 1), size((size_t)size) {}
+
+	bool contains(uint16_t vertex) const { return clock - loadedAt[vertex] <= size; }
+
+	void draw(const std::vector<uint16_t>& strip) {
+		for (uint16_t vertex : strip) {
+			if (contains(vertex)) continue;
+			ring[clock % size] = vertex;
+			loadedAt[vertex] = clock++;
+		}
+	}
+
+	// Cache misses of drawing the strip next, without changing the cache
+	int countMisses(const std::vector<uint16_t>& strip) {
+		stamp++;
+		size_t stripClock = clock;
+		int misses = 0;
+		for (uint16_t vertex : strip) {
+			size_t loaded = stamps[vertex] == stamp ? stampedLoadedAt[vertex] : loadedAt[vertex];
+			if (stripClock - loaded <= size) continue;
+			stamps[vertex] = stamp;
+			stampedLoadedAt[vertex] = stripClock++;
+			misses++;
+		}
+		return misses;
+	}
+};
+
+void MeshStriper::walkCacheStrips(const CompactAdjacency& triangles, int numTriangles, int maxStripTriangles, std::vector<std::vector<uint16_t>>& strips)
+{
+	// Triangles around each vertex, to find the unused triangles touching the cache
+	const uint16_t* vertices = triangles.vertices.data();
+	int vertexCount = 0;
+	for (int i = 0; i < numTriangles * 3; i++) vertexCount = std::max(vertexCount, (int)vertices[i] + 1);
+	std::vector<int> vertexOffsets(vertexCount + 1, 0);
+	for (int i = 0; i < numTriangles * 3; i++) vertexOffsets[vertices[i] + 1]++;
+	for (int v = 0; v < vertexCount; v++) vertexOffsets[v + 1] += vertexOffsets[v];
+	std::vector<int> vertexTriangles((size_t)numTriangles * 3);
+	{
+		std::vector<int> fill(vertexOffsets.begin(), vertexOffsets.end() - 1);
+		for (int i = 0; i < numTriangles * 3; i++) vertexTriangles[fill[vertices[i]]++] = i / 3;
+	}
+
+	std::vector<uint8_t> used(numTriangles, 0);
+	auto available = [&](int triangle) {
+		return triangle != -1 && !used[triangle];
+	};
+	auto availableNeighbours = [&](int triangle) {
+		return available(triangles.getNeighbour(triangle, 0)) + available(triangles.getNeighbour(triangle, 1)) + available(triangles.getNeighbour(triangle, 2));
+	};
+	// Fallback when no unused triangle touches the cache, same order as walkStrips
+	bool leastConnectedFirst = options.leastConnectedFirst;
+	BucketQueue startQueue;
+	if (leastConnectedFirst) {
+		startQueue.reset(numTriangles, 3);
+		for (int t = numTriangles - 1; t >= 0; t--) startQueue.push(t, availableNeighbours(t));
+	}
+	int lastTriangleIndex = 0;
+	auto take = [&](int triangle) {
+		used[triangle] = 1;
+		if (!leastConnectedFirst) return;
+		startQueue.remove(triangle);
+		for (int k = 0; k < 3; k++) {
+			int adjacent = triangles.getNeighbour(triangle, k);
+			if (available(adjacent)) startQueue.changeKey(adjacent, startQueue.key(adjacent) - 1);
+		}
+	};
+
+	StripCache cache(vertexCount, options.cacheSize);
+	std::vector<int> walkStamps(numTriangles, 0);
+	int walkStamp = 0;
+	// Walk forwards from a triangle through unused triangles, leaving it over edge exitEdge, without using them yet
+	auto walk = [&](int first, int exitEdge, std::vector<int>& walkTriangles, std::vector<uint16_t>& strip) {
+		walkStamp++;
+		walkStamps[first] = walkStamp;
+		walkTriangles.assign(1, first);
+		const uint16_t* v = triangles.getVertices(first);
+		strip.assign({ v[(exitEdge + 2) % 3], v[exitEdge], v[(exitEdge + 1) % 3] });
+		int current = first;
+		int edge = exitEdge;
+		while (maxStripTriangles == 0 || (int)walkTriangles.size() < maxStripTriangles) {
+			uint32_t link = triangles.getLink(current, edge);
+			int next = CompactAdjacency::getLinkedTriangle(link);
+			if (!available(next) || walkStamps[next] == walkStamp) break;
+			walkStamps[next] = walkStamp;
+			walkTriangles.push_back(next);
+			int entryEdge = CompactAdjacency::getCounterpartEdge(link);
+			edge = triangles.getNextEdge(next, entryEdge, strip.back());
+			strip.push_back(triangles.getOppositeVertex(next, entryEdge));
+			current = next;
+		}
+	};
+
+	std::vector<int> walkTriangles;
+	std::vector<int> bestTriangles;
+	std::vector<uint16_t> candidate;
+	int usedCount = 0;
+	while (usedCount < numTriangles) {
+		// Start next to the cache: most cached vertices, then fewest unused neighbours, then oldest cached vertex
+		int first = -1;
+		int bestHits = 0;
+		int bestNeighbours = 4;
+		size_t cached = std::min(cache.clock - cache.size - 1, cache.size);
+		for (size_t i = 0; i < cached; i++) {
+			int vertex = cache.ring[(cache.clock - cached + i) % cache.size];
+			for (int j = vertexOffsets[vertex]; j < vertexOffsets[vertex + 1]; j++) {
+				int triangle = vertexTriangles[j];
+				if (used[triangle]) continue;
+				const uint16_t* v = triangles.getVertices(triangle);
+				int hits = cache.contains(v[0]) + cache.contains(v[1]) + cache.contains(v[2]);
+				if (hits < bestHits) continue;
+				int neighbours = availableNeighbours(triangle);
+				if (hits == bestHits && neighbours >= bestNeighbours) continue;
+				first = triangle;
+				bestHits = hits;
+				bestNeighbours = neighbours;
+			}
+		}
+		if (first == -1) {
+			if (leastConnectedFirst) {
+				first = startQueue.popMin();
+				startQueue.push(first, 0); // take removes it again
+			}
 			else {
-				stripData = strip->data();
-				secondVertex = stripData[1];
-				int backEdgeIndex;
-				if (firstVertex < secondVertex) backEdgeIndex = currentBackTri->getEdgeIndex(firstVertex, secondVertex);
-				else backEdgeIndex = currentBackTri->getEdgeIndex(secondVertex, firstVertex);
-				adjacentTriIndex = currentBackTri->adjacentTris[backEdgeIndex];
-				if (indicesPtr[adjacentTriIndex] == -1) break;
-				indicesPtr[adjacentTriIndex] = -1;
-				remainingTriangles--;
-				AdjTriangle* adjacentTri = &triangles[adjacentTriIndex];
-				currentBackTri = adjacentTri;
-				uint16_t newVertex = adjacentTri->getOppositeVertex(firstVertex, secondVertex);
-				strip->insert(strip->begin(), newVertex);
-				stripData = strip->data();
-				secondVertex = stripData[strip->size() - 2];
-				firstVertex = newVertex;
+				while (used[lastTriangleIndex]) lastTriangleIndex++;
+				first = lastTriangleIndex;
 			}
 		}
-		progressBar.updateProgress(numTriangles - remainingTriangles);
+
+		// Head off along the edge that costs the fewest cache misses per triangle, counting a strip start as a miss
+		double bestCost = 0.0;
+		strips.emplace_back();
+		for (int exitEdge = 0; exitEdge < 3; exitEdge++) {
+			walk(first, exitEdge, walkTriangles, candidate);
+			double cost = (double)(cache.countMisses(candidate) + 1) / (double)walkTriangles.size();
+			if (exitEdge > 0 && (cost > bestCost || (cost == bestCost && walkTriangles.size() <= bestTriangles.size()))) continue;
+			bestCost = cost;
+			bestTriangles.swap(walkTriangles);
+			strips.back().swap(candidate);
+		}
+		for (int triangle : bestTriangles) take(triangle);
+		usedCount += (int)bestTriangles.size();
+		cache.draw(strips.back());
 	}
+}
+
+void MeshStriper::generateCacheStrips(const CompactAdjacency& triangles, int numTriangles, std::vector<std::vector<uint16_t>>& strips)
+{
+	auto start = Timer::begin();
+	size_t vertexCount = 0;
+	for (uint16_t vertex : triangles.vertices) vertexCount = std::max(vertexCount, (size_t)vertex + 1);
+	// Long strips need fewer indices, but shorter strips that fit in the cache let the next strip reuse their vertices
+	const int lengthLimits[] = { 0, options.cacheSize * 2, options.cacheSize, options.cacheSize / 2 };
+	std::vector<std::vector<uint16_t>> candidate;
+	size_t bestMisses = 0;
+	int bestLimit = 0;
+	for (int limit : lengthLimits) {
+		if (limit != 0 && limit < 4) continue;
+		candidate.clear();
+		walkCacheStrips(triangles, numTriangles, limit, candidate);
+		size_t misses = CacheOptimizer::simulateStripFIFO(candidate, vertexCount, options.cacheSize);
+		if (limit != 0 && misses >= bestMisses) continue;
+		bestMisses = misses;
+		bestLimit = limit;
+		strips.swap(candidate);
+	}
+	std::cout << "Cache aware strips for (" << options.cacheSize << ") vertices: ACMR " << (numTriangles ? (double)bestMisses / numTriangles : 0.0)
+		<< ", strip length limit " << (bestLimit ? std::to_string(bestLimit) : std::string("none")) << std::endl;
 	Timer::end(start, "Found (" + std::to_string(strips.size()) + ") triangle strips: ");
 }
 
-void MeshStriper::striper(FbxMesh* inMesh, MeshObject* outMesh)
+void MeshStriper::partitionTriangles(const CompactAdjacency& triangles, int numTriangles, int regionCount, std::vector<int>& regions)
+{
+	regions.assign(numTriangles, -1);
+	int* regionsPtr = regions.data();
+	int regionSize = (numTriangles + regionCount - 1) / regionCount;
+	std::vector<int> queue(numTriangles);
+	int* queuePtr = queue.data();
+	int region = 0;
+	int filled = 0;
+	for (int seed = 0; seed < numTriangles; seed++) {
+		if (regionsPtr[seed] != -1) continue;
+		// grow the current region breadth first from the seed, until it's full or the seed's piece of the mesh runs out
+		int head = 0;
+		int tail = 0;
+		queuePtr[tail++] = seed;
+		regionsPtr[seed] = region;
+		filled++;
+		while (head < tail && filled < regionSize) {
+			int triangle = queuePtr[head++];
+			for (int k = 0; k < 3 && filled < regionSize; k++) {
+				int adjacent = triangles.getNeighbour(triangle, k);
+				if (adjacent == -1 || regionsPtr[adjacent] != -1) continue;
+				regionsPtr[adjacent] = region;
+				queuePtr[tail++] = adjacent;
+				filled++;
+			}
+		}
+		if (filled >= regionSize && region < regionCount - 1) {
+			region++;
+			filled = 0;
+		}
+	}
+}
+
+void MeshStriper::generateStripsParallel(const CompactAdjacency& triangles, int numTriangles, std::vector<std::vector<uint16_t>>& strips)
+{
+	auto start = Timer::begin();
+	int regionCount = options.threadCount;
+	std::vector<int> regions;
+	partitionTriangles(triangles, numTriangles, regionCount, regions);
+
+	// Triangles of each region in index order, which is the order strips are started in
+	std::vector<int> regionOffsets(regionCount + 1, 0);
+	for (int region : regions) regionOffsets[region + 1]++;
+	for (int r = 0; r < regionCount; r++) regionOffsets[r + 1] += regionOffsets[r];
+	std::vector<int> regionTriangles(numTriangles);
+	{
+		std::vector<int> fill(regionOffsets.begin(), regionOffsets.end() - 1);
+		for (int t = 0; t < numTriangles; t++) regionTriangles[fill[regions[t]]++] = t;
+	}
+
+	// Strip every region on its own thread. Threads only write the used flags and positions of their own region's triangles.
+	std::vector<uint8_t> used(numTriangles, 0);
+	std::vector<int> positions(numTriangles);
+	std::vector<std::vector<std::vector<uint16_t>>> regionStrips(regionCount);
+	std::vector<std::vector<uint8_t>> regionBlocked(regionCount);
+	std::vector<std::vector<int>> regionStripTriangles(regionCount);
+	Parallel::forRange(regionCount, options.threadCount, [&](size_t begin, size_t end, int) {
+		for (size_t r = begin; r < end; r++) {
+			walkStrips(triangles, &regionTriangles[regionOffsets[r]], regionOffsets[r + 1] - regionOffsets[r], regions.data(), (int)r, used.data(), positions.data(),
+				regionStrips[r], &regionBlocked[r], &regionStripTriangles[r], nullptr);
+		}
+	});
+
+	// Short strips that stopped at a region border are freed, and restriped across the borders
+	std::vector<uint8_t> freed(numTriangles, 0);
+	size_t keptCount = 0;
+	for (int r = 0; r < regionCount; r++) {
+		const int* stripTriangles = regionStripTriangles[r].data();
+		for (size_t i = 0; i < regionStrips[r].size(); i++) {
+			int triangleCount = (int)regionStrips[r][i].size() - 2;
+			if (regionBlocked[r][i] && triangleCount < options.borderRestripLength) {
+				for (int j = 0; j < triangleCount; j++) {
+					used[stripTriangles[j]] = 0;
+					freed[stripTriangles[j]] = 1;
+				}
+				regionStrips[r][i].clear();
+			}
+			else {
+				keptCount++;
+			}
+			stripTriangles += triangleCount;
+		}
+	}
+	std::vector<int> borderTriangles;
+	for (int t = 0; t < numTriangles; t++) {
+		if (freed[t]) borderTriangles.push_back(t);
+	}
+
+	strips.reserve(strips.size() + keptCount);
+	for (int r = 0; r < regionCount; r++) {
+		for (std::vector<uint16_t>& strip : regionStrips[r]) {
+			if (!strip.empty()) strips.push_back(std::move(strip));
+		}
+	}
+	size_t borderStripStart = strips.size();
+	walkStrips(triangles, borderTriangles.data(), (int)borderTriangles.size(), nullptr, 0, used.data(), positions.data(), strips, nullptr, nullptr, nullptr);
+
+	std::cout << "Striped (" << regionCount << ") regions in parallel, restriped (" << borderTriangles.size() << ") border triangles into ("
+		<< strips.size() - borderStripStart << ") strips" << std::endl;
+	Timer::end(start, "Found (" + std::to_string(strips.size()) + ") triangle strips: ");
+}
+
+void MeshStriper::setOptions(const StripOptions& options)
+{
+	this->options = options;
+}
+
+void MeshStriper::createAdjacencies(const std::vector<uint32_t>& triangleList, std::vector<AdjTriangle>& adjacencies)
+{
+	adjacencies.assign(triangleList.size() / 3, AdjTriangle());
+	if (adjacencies.empty()) return;
+	bool hashed = options.adjacencyBuilder == AdjacencyBuilder::Hash
+		|| (options.adjacencyBuilder == AdjacencyBuilder::Auto && (int)adjacencies.size() < sortLinkTriangleCount);
+	if (options.threadCount > 1 && (int)adjacencies.size() >= parallelTriangleCount) {
+		linkTriangleStructuresParallel(adjacencies, triangleList.data(), hashed);
+		return;
+	}
+	createTriangleStructures(adjacencies, triangleList.data());
+	if (hashed) hashTriangleStructures(adjacencies);
+	else linkTriangleStructures(adjacencies);
+}
+
+bool MeshStriper::striper(MeshObject* mesh)
 {
 #if _DEBUG
 	auto start = Timer::begin();
-	int triangleCount = inMesh->GetPolygonCount();
+	int triangleCount = (int)mesh->triangleList.size() / 3;
 	std::cout << "Found (" << triangleCount << ") triangles" << std::endl;
 #else
-	int triangleCount = inMesh->GetPolygonCount();
+	int triangleCount = (int)mesh->triangleList.size() / 3;
 #endif
 
-	int* vertices = inMesh->GetPolygonVertices();
-	std::vector<AdjTriangle> adjacencies(triangleCount);
-	createTriangleStructures(adjacencies, vertices);
-	linkTriangleStructures(adjacencies);
-	generateStrips(adjacencies, triangleCount, outMesh->triangleStrips);
+	std::vector<AdjTriangle> adjacencies;
+	createAdjacencies(mesh->triangleList, adjacencies);
+	// Strips are walked through the compact copy. The full structures are only kept for the tunneler.
+	CompactAdjacency triangles;
+	triangles.build(adjacencies, options.threadCount);
+	bool tunnel = options.tunnelSeconds > 0.0 && options.cacheSize == 0;
+	if (!tunnel) std::vector<AdjTriangle>().swap(adjacencies);
+	if (options.cacheSize > 0) generateCacheStrips(triangles, triangleCount, mesh->triangleStrips);
+	else if (options.threadCount > 1 && triangleCount >= parallelTriangleCount) generateStripsParallel(triangles, triangleCount, mesh->triangleStrips);
+	else generateStrips(triangles, triangleCount, mesh->triangleStrips);
+	if (tunnel) {
+		StripTunneler tunneler;
+		tunneler.improve(adjacencies.data(), triangleCount, mesh->triangleStrips, options.tunnelSeconds);
+	}
+	mesh->primitiveType = MeshObject::PrimitiveType::TriangleStrips;
+	mesh->triangleList.clear();
 
 #if _DEBUG
-	int memoryUsage = 0;
-	memoryUsage += triangleCount * 36;
+	size_t memoryUsage = triangles.memoryUsage() + adjacencies.size() * sizeof(AdjTriangle);
 	std::cout << "Striper memory usage: " << memoryUsage << " bytes\n";
 #endif
+	return true;
 }
\ No newline at end of file
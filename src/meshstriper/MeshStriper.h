@@ -1,8 +1,9 @@
 #ifndef SRC_MESHSTRIPER_MESHSTRIPER_H_
 #define SRC_MESHSTRIPER_MESHSTRIPER_H_
 
-#include <fbxsdk.h>
 #include <model/MeshObject.h>
+#include <meshstriper/StripBackend.h>
+#include <meshstriper/Sorter.h>
 #include <unordered_map>
 
 struct Edge {
@@ -22,7 +23,7 @@ struct AdjTriangle {
 	/// <param name="v1"> - first vertex</param>
 	/// <param name="v2"> - second vertex</param>
 	/// <param name="v3"> - third vertex</param>
-	void createEdges(int* vertices, int vertexIndex);
+	void createEdges(const uint32_t* vertices, int vertexIndex);
 
 	/// <summary>
 	/// <para/>Return the index of the edge formed by the given vertices.
@@ -31,8 +32,8 @@ struct AdjTriangle {
 	/// <param name="v1"> - first vertex</param>
 	/// <param name="v2"> - second vertex</param>
 	/// <returns></returns>
-	int getEdgeIndex(uint16_t v1, uint16_t v2);
-	int getEdgeIndex(uint32_t edge);
+	int getEdgeIndex(uint16_t v1, uint16_t v2) const;
+	int getEdgeIndex(uint32_t edge) const;
 
 	/// <summary>
 	/// Given two vertices, return the third vertex in the triangle.
@@ -40,17 +41,105 @@ struct AdjTriangle {
 	/// <param name="v1"> - first vertex</param>
 	/// <param name="v2"> - second vertex</param>
 	/// <returns></returns>
-	uint16_t getOppositeVertex(uint16_t v1, uint16_t v2);
+	uint16_t getOppositeVertex(uint16_t v1, uint16_t v2) const;
 };
 
-class MeshStriper {
+/// <summary>
+/// <para/>Compact copy of linked AdjTriangles that strips are walked through, 18 bytes per triangle instead of 44.
+/// <para/>The vertices of all triangles are in one array and their links in another. Each link holds the neighbour over
+/// that edge in the low 30 bits and the number of the same edge in the neighbour in the top 2 bits, so a walk steps
+/// from edge to edge without searching. Edges aren't stored, edge k runs from vertex k to vertex k + 1.
+/// </summary>
+struct CompactAdjacency {
+	static const uint32_t noLink = 0xFFFFFFFF;
+
+	std::vector<uint16_t> vertices; // 3 per triangle
+	std::vector<uint32_t> links; // 3 per triangle, neighbour | (counterpart edge << 30), noLink on a border
+
+	/// <summary>
+	/// Copy the vertices and links of linked triangles.
+	/// </summary>
+	/// <param name="triangles">- linked triangles</param>
+	/// <param name="threadCount">- number of threads to copy with</param>
+	void build(const std::vector<AdjTriangle>& triangles, int threadCount);
+
+	int size() const { return (int)(links.size() / 3); }
+	size_t memoryUsage() const { return vertices.size() * sizeof(uint16_t) + links.size() * sizeof(uint32_t); }
+	const uint16_t* getVertices(int triangle) const { return &vertices[(size_t)triangle * 3]; }
+	uint32_t getLink(int triangle, int edge) const { return links[(size_t)triangle * 3 + edge]; }
+
+	/// <summary>
+	/// Neighbour of a triangle over one of its edges, or -1 if there is none.
+	/// </summary>
+	int getNeighbour(int triangle, int edge) const { return getLinkedTriangle(getLink(triangle, edge)); }
+
+	/// <summary>
+	/// Triangle a link leads to, or -1 for noLink.
+	/// </summary>
+	static int getLinkedTriangle(uint32_t link) { return link == noLink ? -1 : (int)(link & 0x3FFFFFFF); }
+
+	/// <summary>
+	/// Number of the linked edge in the triangle a link leads to.
+	/// </summary>
+	static int getCounterpartEdge(uint32_t link) { return (int)(link >> 30); }
+
+	/// <summary>
+	/// The vertex that isn't on the given edge.
+	/// </summary>
+	uint16_t getOppositeVertex(int triangle, int edge) const { return vertices[(size_t)triangle * 3 + (edge + 2) % 3]; }
+
+	/// <summary>
+	/// The edge from one end of an edge to the opposite vertex, which a strip leaves over after entering over the edge.
+	/// </summary>
+	/// <param name="triangle">- triangle</param>
+	/// <param name="edge">- edge the strip entered over</param>
+	/// <param name="vertex">- vertex of the edge that stays in the strip</param>
+	int getNextEdge(int triangle, int edge, uint16_t vertex) const
+	{
+		return vertices[(size_t)triangle * 3 + (edge + 1) % 3] == vertex ? (edge + 1) % 3 : (edge + 2) % 3;
+	}
+};
+
+class ProgressBar;
+
+class MeshStriper : public StripBackend {
 private:
+	StripOptions options;
+
+	/// <summary>
+	/// Edges that one thread links by sorting them, and the sorter they're sorted with.
+	/// </summary>
+	struct EdgeSortBuffers {
+		std::vector<uint32_t> edgeKeys; // (v1 << 16) | v2 of each edge
+		std::vector<int> faceIndices; // triangle of each edge
+		Sorter sorter;
+	};
+	// [0] for linkTriangleStructures, one per thread in linkTriangleStructuresParallel. They last as long as this MeshStriper, so linking
+	// again with it, as the adjacency benchmark does, allocates no sort buffers. The pipeline creates a MeshStriper per mesh.
+	std::vector<EdgeSortBuffers> edgeBuffers;
+
 	/// <summary>
 	/// For each triangle, create an AdjTriangle struct with 3 edges and 3 vertices
 	/// </summary>
 	/// <param name="triangles">- array to populate with triangles</param>
 	/// <param name="vertices">- array of vertices to create triangles from</param>
-	void createTriangleStructures(std::vector<AdjTriangle>& triangles, int* vertices);
+	void createTriangleStructures(std::vector<AdjTriangle>& triangles, const uint32_t* vertices);
+
+	/// <summary>
+	/// <para/>Fill in the vertices and edges of triangles begin to end - 1, 8 triangles per iteration using AVX2.
+	/// The edges are ordered with min/max and packed into their (v1 &lt;&lt; 16) | v2 keys without branches.
+	/// <para/>Returns the first triangle that wasn't filled in, the caller does the rest with AdjTriangle::createEdges.
+	/// </summary>
+	static size_t createEdgesAVX2(AdjTriangle* triangles, const uint32_t* vertices, size_t begin, size_t end);
+
+	/// <summary>
+	/// Fill in the vertices and edges of triangles begin to end - 1, with createEdgesAVX2 when the CPU supports it.
+	/// </summary>
+	/// <param name="triangles">- array of triangles</param>
+	/// <param name="vertices">- triangle list</param>
+	/// <param name="begin">- first triangle</param>
+	/// <param name="end">- one past the last triangle</param>
+	static void createEdges(AdjTriangle* triangles, const uint32_t* vertices, size_t begin, size_t end);
 
 	/// <summary>
 	/// <para/>Create a link between two given triangles by updating their respective adjacency structures.
@@ -67,33 +156,155 @@ private:
 	void updateLink(AdjTriangle* triangles, int firstTri, int secondTri, uint32_t edge);
 
 	/// <summary>
-	/// <para/>Link the adjacency structures by creating a list of all edges in the mesh and sorting by the second vertex of each edge.
-	/// <para/>This creates a list of indexes, each index leading to an element in the unsorted list.
-	/// <para/>For example, if the unsorted edges are [4, 8, 2, 6, 3, 2], and the sorted indexes are [2, 5, 4, 0, 3, 1],
-	/// then indexing the unsorted edges using the sorted index array would produce [2, 2, 3, 4, 6, 8].
-	/// <para/>The sorted index array can then be used to obtain the first vertex, second vertex, and face index for
-	/// every edge.
-	/// <para/>By looping through the sorted index array you can quickly identify matching edges and create the corresponding links between triangles.
+	/// <para/>Link the adjacency structures by creating a list of all edges in the mesh and sorting it.
+	/// <para/>Every edge is a packed key (v1 &lt;&lt; 16) | v2 with its face index as the value, and the pairs are sorted together,
+	/// in one stable radix sort.
+	/// <para/>The copies of a shared edge then sit next to each other, so one linear pass over the sorted pairs finds the matching
+	/// edges and creates the corresponding links between triangles.
 	/// </summary>
 	/// <param name="triangles">- array of triangles</param>
 	void linkTriangleStructures(std::vector<AdjTriangle>& triangles);
 
+	/// <summary>
+	/// <para/>Sort a list of edges and link the triangles that share them, the second half of linkTriangleStructures.
+	/// <para/>Edges with more than 2 copies are non-manifold and stay unlinked.
+	/// </summary>
+	/// <param name="triangles">- array of triangles</param>
+	/// <param name="buffers">- edges to link and their triangles, sorted on return, owned by the calling thread</param>
+	/// <returns>Bytes of memory used by the sort</returns>
+	int linkSortedEdges(AdjTriangle* triangles, EdgeSortBuffers& buffers);
+
+	/// <summary>
+	/// <para/>Link the adjacency structures in one pass over the edges, with a linear probing hash table of packed edges
+	/// ((v1 &lt;&lt; 16) | v2) that has at least twice as many slots as there are edges.
+	/// <para/>Two triangles are linked when the second one finds the edge of the first. A third triangle on the same edge
+	/// unlinks them again, so edges shared by more than 2 triangles stay unlinked, as with linkTriangleStructures.
+	/// </summary>
+	/// <param name="triangles">- array of triangles</param>
+	void hashTriangleStructures(std::vector<AdjTriangle>& triangles);
+
+	/// <summary>
+	/// Link the triangles that share the given edges through a hash table, see hashTriangleStructures.
+	/// </summary>
+	/// <param name="triangles">- array of triangles</param>
+	/// <param name="edgeList">- edges to link, each one triangle * 3 + edge index, or nullptr for every edge of the first edgeCount / 3 triangles</param>
+	/// <param name="edgeCount">- number of edges</param>
+	/// <returns>Size of the hash table in bytes</returns>
+	size_t hashEdges(AdjTriangle* triangles, const int* edgeList, int edgeCount);
+
+	/// <summary>
+	/// <para/>Multithreaded createTriangleStructures followed by linking, used by createAdjacencies for large meshes when options.threadCount is above 1.
+	/// <para/>The edges are bucketed into one partition per thread by the range their smaller vertex falls in, so both copies
+	/// of a shared edge are in the same partition. Every partition is then sorted or hashed on its own thread,
+	/// and no two threads write the same link. The links are the same as the single threaded builders make.
+	/// </summary>
+	/// <param name="triangles">- array of triangles, one per triangle of the list</param>
+	/// <param name="vertices">- triangle list</param>
+	/// <param name="hashed">- hash the partitions instead of sorting them</param>
+	void linkTriangleStructuresParallel(std::vector<AdjTriangle>& triangles, const uint32_t* vertices, bool hashed);
+
 	/// <summary>
 	/// <para/>Generate triangle strips by walking through adjacency structures until no more adjacent triangles can be found.
 	/// <para/>Strips are extended both forwards and backwards to maximise their lengths.
 	/// </summary>
-	/// <param name="triangles">- array of triangles</param>
+	/// <param name="triangles">- compact linked triangles</param>
 	/// <param name="numTriangles">- number of triangles in array</param>
 	/// <param name="strips">- array to put strips into</param>
-	void generateStrips(std::vector<AdjTriangle>& triangles, int numTriangles, std::vector<std::vector<uint16_t>>& strips);
+	void generateStrips(const CompactAdjacency& triangles, int numTriangles, std::vector<std::vector<uint16_t>>& strips);
+
+	/// <summary>
+	/// <para/>Greedy strip walk used by generateStrips and generateStripsParallel.
+	/// <para/>Strips only grow into unused triangles of the same region. They are started from the start triangle with the fewest
+	/// unused neighbours left (SGI ordering), kept in a bucket queue that is updated as triangles are used,
+	/// or from startTriangles in order if options.leastConnectedFirst is off.
+	/// </summary>
+	/// <param name="triangles">- compact linked triangles</param>
+	/// <param name="startTriangles">- triangles to start strips from, in order. Every triangle of the region must be in here.</param>
+	/// <param name="startCount">- number of start triangles</param>
+	/// <param name="regions">- region of each triangle, or nullptr to ignore regions</param>
+	/// <param name="region">- region to stripe</param>
+	/// <param name="used">- 1 for each triangle that is already in a strip, updated as strips are made</param>
+	/// <param name="positions">- scratch with room for every triangle, gets the position of each start triangle in startTriangles</param>
+	/// <param name="strips">- array to put strips into</param>
+	/// <param name="blockedStrips">- optional, gets 1 for each new strip that stopped next to a triangle of another region</param>
+	/// <param name="stripTriangles">- optional, gets the triangles of each new strip, one strip after another</param>
+	/// <param name="progressBar">- optional progress bar, updated with the number of triangles used</param>
+	void walkStrips(const CompactAdjacency& triangles, const int* startTriangles, int startCount, const int* regions, int region, uint8_t* used, int* positions,
+		std::vector<std::vector<uint16_t>>& strips, std::vector<uint8_t>* blockedStrips, std::vector<int>* stripTriangles, ProgressBar* progressBar);
+
+	/// <summary>
+	/// <para/>Cache aware strip walk, used when options.cacheSize is set. Strips are only grown forwards, so they are drawn in the
+	/// order they are walked, while a FIFO post-transform cache of options.cacheSize vertices is simulated.
+	/// <para/>Each strip starts at the unused triangle with the most vertices in the cache, then the fewest unused neighbours,
+	/// and leaves it over whichever of its 3 edges gives the fewest cache misses per triangle.
+	/// </summary>
+	/// <param name="triangles">- compact linked triangles</param>
+	/// <param name="numTriangles">- number of triangles in array</param>
+	/// <param name="maxStripTriangles">- strips are cut off at this many triangles, 0 for no limit</param>
+	/// <param name="strips">- array to put strips into</param>
+	void walkCacheStrips(const CompactAdjacency& triangles, int numTriangles, int maxStripTriangles, std::vector<std::vector<uint16_t>>& strips);
+
+	/// <summary>
+	/// Cache aware version of generateStrips. The strips are walked with no length limit and with limits around the cache size,
+	/// and the strips with the fewest simulated cache misses are kept.
+	/// </summary>
+	/// <param name="triangles">- compact linked triangles</param>
+	/// <param name="numTriangles">- number of triangles in array</param>
+	/// <param name="strips">- array to put strips into</param>
+	void generateCacheStrips(const CompactAdjacency& triangles, int numTriangles, std::vector<std::vector<uint16_t>>& strips);
+
+	/// <summary>
+	/// <para/>Split the triangles into regionCount regions of equal size, grown breadth first through the adjacency from
+	/// the lowest unassigned triangle, so each region is a compact patch with a short border.
+	/// </summary>
+	/// <param name="triangles">- compact linked triangles</param>
+	/// <param name="numTriangles">- number of triangles in array</param>
+	/// <param name="regionCount">- number of regions</param>
+	/// <param name="regions">- region of each triangle</param>
+	void partitionTriangles(const CompactAdjacency& triangles, int numTriangles, int regionCount, std::vector<int>& regions);
+
+	/// <summary>
+	/// <para/>Parallel version of generateStrips. The mesh is partitioned into one region per thread, and each region is striped on its own thread.
+	/// <para/>Short strips that were cut off by a region border are then broken up again, and their triangles restriped on the
+	/// calling thread without regions, so strips can continue across the borders.
+	/// <para/>Results only depend on the thread count.
+	/// </summary>
+	/// <param name="triangles">- compact linked triangles</param>
+	/// <param name="numTriangles">- number of triangles in array</param>
+	/// <param name="strips">- array to put strips into</param>
+	void generateStripsParallel(const CompactAdjacency& triangles, int numTriangles, std::vector<std::vector<uint16_t>>& strips);
 public:
 	/// <summary>
-	/// <para/>Converts a triangulated mesh into an array of triangle strips.
-	/// <para/>The strips are stored in outMesh.triangleStrips
+	/// Meshes with fewer triangles than this are always linked and striped on one thread.
+	/// </summary>
+	static const int parallelTriangleCount = 50000;
+
+	/// <summary>
+	/// <para/>With AdjacencyBuilder::Auto, meshes with at least this many triangles are linked by sorting, and smaller meshes by hashing.
+	/// <para/>On grids in Morton order, as the pipeline hands them over by default, hashing is faster up to about 13k triangles
+	/// and sorting from about 20k on. The hash table outgrows the cache, and its slots don't follow the triangle order.
+	/// </summary>
+	static const int sortLinkTriangleCount = 16384;
+
+	const char* getName() const override { return "meshstriper"; }
+	void setOptions(const StripOptions& options) override;
+
+	/// <summary>
+	/// Create the linked triangle structures that strips are walked through, with the builder picked by options.adjacencyBuilder,
+	/// on options.threadCount threads for meshes with at least parallelTriangleCount triangles. Also used by TreeStriper.
+	/// </summary>
+	/// <param name="triangleList">- triangle list, 3 indices per triangle</param>
+	/// <param name="adjacencies">- gets one linked triangle per triangle in the list</param>
+	void createAdjacencies(const std::vector<uint32_t>& triangleList, std::vector<AdjTriangle>& adjacencies);
+
+	/// <summary>
+	/// <para/>Converts the triangle list of a mesh into an array of triangle strips.
+	/// <para/>The strips are stored in mesh.triangleStrips, and the triangle list is cleared.
+	/// <para/>With options.tunnelSeconds set, the strips are joined further by StripTunneler, unless they were made for the vertex cache.
 	/// </summary>
-	/// <param name="inMesh">- fbx mesh</param>
-	/// <param name="outMesh">- output mesh to put triangle strips into</param>
-	void striper(FbxMesh* inMesh, MeshObject* outMesh);
+	/// <param name="mesh">- mesh with a triangle list, to put triangle strips into</param>
+	/// <returns>Always true</returns>
+	bool striper(MeshObject* mesh) override;
 };
 
 #endif
\ No newline at end of file
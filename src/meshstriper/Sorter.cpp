@@ -1,5 +1,6 @@
 #include <iostream>
 #include <numeric>
+#include <cstring>
 #include <meshstriper/Sorter.h>
 #include <util/Timer.hpp>
 
@@ -13,9 +14,9 @@ void Sorter::sortFast(std::vector<uint16_t>& inputArray, std::vector<int>& outpu
 		*memoryUsage += numElements * sizeof(int);
 	}
 
-	std::vector<int> counts(maxValue + 1);
+	fastCounts.assign(maxValue + 1, 0);
 	uint16_t* inputPtr = inputArray.data();
-	int* countsPtr = counts.data();
+	int* countsPtr = fastCounts.data();
 
 	// create counts
 	for (uint16_t value : inputArray) {
@@ -23,12 +24,15 @@ void Sorter::sortFast(std::vector<uint16_t>& inputArray, std::vector<int>& outpu
 	}
 
 	// create offsets
-	std::partial_sum(counts.begin(), counts.end(), counts.begin());
+	std::partial_sum(fastCounts.begin(), fastCounts.end(), fastCounts.begin());
 
 	// get sorted values
-	std::vector<int> inputIndices(numElements);
-	std::iota(inputIndices.begin(), inputIndices.end(), 0);
-	int* inputIndicesPtr = inputIndices.data();
+	if ((int)identityIndices.size() < numElements) {
+		size_t first = identityIndices.size();
+		identityIndices.resize(numElements);
+		std::iota(identityIndices.begin() + first, identityIndices.end(), (int)first);
+	}
+	int* inputIndicesPtr = identityIndices.data();
 	int* outputPtr = outputIndices.data();
 	for (int i = numElements - 1; i >= 0; i--) {
 		uint16_t element = inputPtr[i];
@@ -47,9 +51,9 @@ void Sorter::sortFast(std::vector<uint16_t>& inputArray, std::vector<int>& input
 		*memoryUsage += numElements * sizeof(int);
 	}
 
-	std::vector<int> counts(maxValue + 1);
+	fastCounts.assign(maxValue + 1, 0);
 	uint16_t* inputPtr = inputArray.data();
-	int* countsPtr = counts.data();
+	int* countsPtr = fastCounts.data();
 	int* inputIndicesPtr = inputIndices.data();
 
 	// create counts
@@ -58,7 +62,7 @@ void Sorter::sortFast(std::vector<uint16_t>& inputArray, std::vector<int>& input
 	}
 
 	// create offsets
-	std::partial_sum(counts.begin(), counts.end(), counts.begin());
+	std::partial_sum(fastCounts.begin(), fastCounts.end(), fastCounts.begin());
 
 	// get sorted values
 	int* outputPtr = outputIndices.data();
@@ -78,20 +82,21 @@ void Sorter::sortRadix(std::vector<uint16_t>& inputArray, std::vector<int>& outp
 		maxValue = maxValue / 10;
 		++digit;
 	}
+	digit = std::max(digit, 1); // all zeros still need one pass to fill outputIndices
 	int numElements = (int)inputArray.size();
-	std::vector<int> inputIndices(numElements);
-
 	if (memoryUsage != nullptr) {
 		*memoryUsage = numElements * sizeof(int); // inputIndices
 		*memoryUsage += numElements * sizeof(uint8_t); // singleDigits
 		*memoryUsage += 40; // countArray
 	}
 
-	std::iota(inputIndices.begin(), inputIndices.end(), 0);
+	// radixIndices is overwritten between passes, so it's refilled every call
+	radixIndices.resize(numElements);
+	std::iota(radixIndices.begin(), radixIndices.end(), 0);
 	for (int i = 0; i < digit; i++) {
-		countSort(inputArray, inputIndices, outputIndices, i + 1);
+		countSort(inputArray, radixIndices, outputIndices, i + 1);
 		if (i == digit - 1) break;
-		memcpy(inputIndices.data(), outputIndices.data(), numElements * 4);
+		memcpy(radixIndices.data(), outputIndices.data(), numElements * 4);
 		memset(outputIndices.data(), 0, numElements * 4);
 	}
 }
@@ -104,6 +109,7 @@ void Sorter::sortRadix(std::vector<uint16_t>& inputArray, std::vector<int>& inpu
 		maxValue = maxValue / 10;
 		++digit;
 	}
+	digit = std::max(digit, 1); // all zeros still need one pass to fill outputIndices
 	int numElements = (int)inputArray.size();
 
 	if (memoryUsage != nullptr) {
@@ -122,7 +128,7 @@ void Sorter::sortRadix(std::vector<uint16_t>& inputArray, std::vector<int>& inpu
 void Sorter::countSort(std::vector<uint16_t>& inputArray, std::vector<int>& inputIndices, std::vector<int>& outputIndices, int digit)
 {
 	int numElements = (int)inputArray.size();
-	singleDigits.reserve(numElements);
+	if ((int)singleDigits.size() < numElements) singleDigits.resize(numElements);
 	uint8_t* singlePtr = singleDigits.data();
 	int* inputPtr = inputIndices.data();
 	int* outputPtr = outputIndices.data();
@@ -148,4 +154,46 @@ void Sorter::countSort(std::vector<uint16_t>& inputArray, std::vector<int>& inpu
 		outputPtr[countArray[element] - 1] = inputPtr[i];
 		countArray[element]--;
 	}
+}
+
+void Sorter::sortBytes(std::vector<uint16_t>& inputArray, std::vector<int>& outputIndices, int* memoryUsage)
+{
+	KeySorter<uint16_t, 8>::sortIndices(inputArray, outputIndices, byteWorkspace);
+	if (memoryUsage != nullptr) *memoryUsage = (int)byteWorkspace.memoryUsage();
+}
+
+void Sorter::sortBytes(std::vector<uint16_t>& inputArray, std::vector<int>& inputIndices, std::vector<int>& outputIndices, int* memoryUsage)
+{
+	KeySorter<uint16_t, 8>::sortIndices(inputArray, inputIndices, outputIndices, byteWorkspace);
+	if (memoryUsage != nullptr) *memoryUsage = (int)byteWorkspace.memoryUsage();
+}
+
+void Sorter::sortFastParallel(std::vector<uint16_t>& inputArray, std::vector<int>& outputIndices, int threadCount, int* memoryUsage)
+{
+	KeySorter<uint16_t, 16>::sortIndices(inputArray, outputIndices, fastWorkspace, threadCount);
+	if (memoryUsage != nullptr) *memoryUsage = (int)fastWorkspace.memoryUsage();
+}
+
+void Sorter::sortFastParallel(std::vector<uint16_t>& inputArray, std::vector<int>& inputIndices, std::vector<int>& outputIndices, int threadCount, int* memoryUsage)
+{
+	KeySorter<uint16_t, 16>::sortIndices(inputArray, inputIndices, outputIndices, fastWorkspace, threadCount);
+	if (memoryUsage != nullptr) *memoryUsage = (int)fastWorkspace.memoryUsage();
+}
+
+void Sorter::sortBytesParallel(std::vector<uint16_t>& inputArray, std::vector<int>& outputIndices, int threadCount, int* memoryUsage)
+{
+	KeySorter<uint16_t, 8>::sortIndices(inputArray, outputIndices, byteWorkspace, threadCount);
+	if (memoryUsage != nullptr) *memoryUsage = (int)byteWorkspace.memoryUsage();
+}
+
+void Sorter::sortBytesParallel(std::vector<uint16_t>& inputArray, std::vector<int>& inputIndices, std::vector<int>& outputIndices, int threadCount, int* memoryUsage)
+{
+	KeySorter<uint16_t, 8>::sortIndices(inputArray, inputIndices, outputIndices, byteWorkspace, threadCount);
+	if (memoryUsage != nullptr) *memoryUsage = (int)byteWorkspace.memoryUsage();
+}
+
+void Sorter::sortPairs(std::vector<uint32_t>& keys, std::vector<int>& values, int* memoryUsage)
+{
+	KeySorter<uint32_t>::sortPairs(keys, values, pairWorkspace32);
+	if (memoryUsage != nullptr) *memoryUsage = (int)pairWorkspace32.memoryUsage();
 }
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include <meshstriper/StripBackend.h>
+#include <meshstriper/MeshStriper.h>
+#include <meshstriper/TreeStriper.h>
+#include <stripernew/Strips.h>
+
+const StripBackendType StripBackend::allTypes[3] = { StripBackendType::MeshStriper, StripBackendType::Striper, StripBackendType::TreeStriper };
+
+std::unique_ptr<StripBackend> StripBackend::create(StripBackendType type, const StripOptions& options)
+{
+	std::unique_ptr<StripBackend> backend;
+	if (type == StripBackendType::Striper) backend.reset(new StriperBackend());
+	else if (type == StripBackendType::TreeStriper) backend.reset(new TreeStriper());
+	else backend.reset(new MeshStriper());
+	backend->setOptions(options);
+	return backend;
+}
+
+bool StripBackend::parseType(const std::string& name, StripBackendType& type)
+{
+	for (StripBackendType candidate : allTypes) {
+		if (name == create(candidate)->getName()) {
+			type = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool StripBackend::keepsWinding(StripBackendType type, const StripOptions& options)
+{
+	if (type == StripBackendType::TreeStriper) return true;
+	if (type == StripBackendType::Striper) return options.oneSided;
+	return false;
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#ifndef SRC_MESHSTRIPER_STRIPBACKEND_H_
+#define SRC_MESHSTRIPER_STRIPBACKEND_H_
+
+#include <memory>
+#include <string>
+#include <model/MeshObject.h>
+
+enum class StripBackendType {
+	MeshStriper, // greedy walker in src/meshstriper
+	Striper, // Terdiman's striper in src/stripernew, tries 3 strips per start face and keeps the longest
+	TreeStriper // path cover of a spanning tree of the triangle adjacency, generalized strips with swaps
+};
+
+enum class AdjacencyBuilder {
+	Auto, // hash below MeshStriper::sortLinkTriangleCount triangles, sort from there on
+	Sort, // counting sort of the edges by both vertices, see MeshStriper::linkTriangleStructures
+	Hash // open addressing hash table of the edges, see MeshStriper::hashTriangleStructures
+};
+
+/// <summary>
+/// Settings shared by the strip backends. Backends ignore the settings they don't support.
+/// </summary>
+struct StripOptions {
+	int threadCount = 1; // threads that link the triangles of large meshes, and regions striped in parallel (MeshStriper), 1 for the calling thread only
+	int borderRestripLength = 32; // strips shorter than this (in triangles) that stop at a region border are restriped across it (MeshStriper)
+	bool leastConnectedFirst = true; // start each strip at the triangle with the fewest unused neighbours (SGI), instead of in index order
+	int cacheSize = 0; // FIFO post-transform cache size to grow strips for, 0 to only optimize strip length (MeshStriper)
+	double tunnelSeconds = 0.0; // time budget of the tunneling pass that joins strips after the walk, 0 to skip it (MeshStriper)
+	AdjacencyBuilder adjacencyBuilder = AdjacencyBuilder::Auto; // how shared edges are found (MeshStriper, TreeStriper)
+	bool oneSided = false; // keep the winding of every triangle, at the cost of extra indices (Striper)
+	int speculativeStarts = 0; // start faces whose 3 strips are tracked at once on threadCount threads, 0 to track one face at a time (Striper)
+
+	static const int maxSpeculativeStarts = 4096; // more guesses than this only go stale before they're used, and cost memory for their strips
+};
+
+/// <summary>
+/// <para/>Common interface of the triangle strip generators, so the pipeline and the benchmarks can pick one at runtime.
+/// <para/>Backends read mesh.triangleList and fill mesh.triangleStrips.
+/// </summary>
+class StripBackend {
+public:
+	virtual ~StripBackend() {}
+
+	/// <summary>
+	/// Name of the backend, as used on the command line.
+	/// </summary>
+	virtual const char* getName() const = 0;
+
+	/// <summary>
+	/// Change the striper settings.
+	/// </summary>
+	/// <param name="options">- new settings</param>
+	virtual void setOptions(const StripOptions& options) = 0;
+
+	/// <summary>
+	/// <para/>Converts the triangle list of a mesh into an array of triangle strips.
+	/// <para/>The strips are stored in mesh.triangleStrips, and the triangle list is cleared.
+	/// </summary>
+	/// <param name="mesh">- mesh with a triangle list, to put triangle strips into</param>
+	/// <returns>False if the backend can't stripe this mesh. The mesh is left untouched.</returns>
+	virtual bool striper(MeshObject* mesh) = 0;
+
+	/// <summary>
+	/// Create a backend.
+	/// </summary>
+	/// <param name="type">- which backend</param>
+	/// <param name="options">- settings to give it</param>
+	static std::unique_ptr<StripBackend> create(StripBackendType type, const StripOptions& options = StripOptions());
+
+	/// <summary>
+	/// Look up a backend by its command line name.
+	/// </summary>
+	/// <param name="name">- "meshstriper", "striper" or "treestriper"</param>
+	/// <param name="type">- backend with that name</param>
+	/// <returns>False if there is no backend with that name</returns>
+	static bool parseType(const std::string& name, StripBackendType& type);
+
+	/// <summary>
+	/// Whether a backend draws every triangle with the winding it has in the triangle list.
+	/// </summary>
+	/// <param name="type">- which backend</param>
+	/// <param name="options">- settings it runs with</param>
+	/// <returns>True for treestriper, and for striper with options.oneSided</returns>
+	static bool keepsWinding(StripBackendType type, const StripOptions& options);
+
+	static const StripBackendType allTypes[3];
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include <iostream>
+#include <string>
+#include <meshstriper/StripStitcher.h>
+#include <util/Timer.hpp>
+
+size_t StripStitcher::countDegenerateIndices(const std::vector<std::vector<uint16_t>>& strips)
+{
+	size_t numIndices = 0;
+	for (const std::vector<uint16_t>& strip : strips) {
+		if (strip.size() < 3) continue;
+		if (numIndices > 0) {
+			numIndices += 2;
+			if (numIndices & 1) numIndices++;
+		}
+		numIndices += strip.size();
+	}
+	return numIndices;
+}
+
+size_t StripStitcher::countRestartIndices(const std::vector<std::vector<uint16_t>>& strips)
+{
+	size_t numIndices = 0;
+	for (const std::vector<uint16_t>& strip : strips) {
+		if (strip.size() < 3) continue;
+		if (numIndices > 0) numIndices++;
+		numIndices += strip.size();
+	}
+	return numIndices;
+}
+
+StitchMode StripStitcher::chooseMode(const std::vector<std::vector<uint16_t>>& strips, size_t vertexCount, int drawCallCost)
+{
+	size_t separateIndices = 0;
+	size_t drawCalls = 0;
+	for (const std::vector<uint16_t>& strip : strips) {
+		if (strip.size() < 3) continue;
+		separateIndices += strip.size();
+		drawCalls++;
+	}
+	double separateCost = (double)separateIndices + (double)drawCalls * drawCallCost;
+	double degenerateCost = (double)countDegenerateIndices(strips) + drawCallCost;
+	StitchMode best = StitchMode::None;
+	double bestCost = separateCost;
+	if (degenerateCost < bestCost) {
+		best = StitchMode::Degenerate;
+		bestCost = degenerateCost;
+	}
+	if (vertexCount <= MeshObject::stripRestartIndex) {
+		double restartCost = (double)countRestartIndices(strips) + drawCallCost;
+		if (restartCost < bestCost) best = StitchMode::Restart;
+	}
+	return best;
+}
+
+void StripStitcher::stitchDegenerate(const std::vector<std::vector<uint16_t>>& strips, std::vector<uint16_t>& outStrip)
+{
+	outStrip.clear();
+	outStrip.reserve(countDegenerateIndices(strips));
+	for (const std::vector<uint16_t>& strip : strips) {
+		if (strip.size() < 3) continue;
+		if (!outStrip.empty()) {
+			uint16_t last = outStrip.back();
+			outStrip.push_back(last);
+			outStrip.push_back(strip[0]);
+			// an odd start would flip the winding of every triangle in the strip
+			if (outStrip.size() & 1) outStrip.push_back(strip[0]);
+		}
+		outStrip.insert(outStrip.end(), strip.begin(), strip.end());
+	}
+}
+
+void StripStitcher::stitchRestart(const std::vector<std::vector<uint16_t>>& strips, std::vector<uint16_t>& outStrip)
+{
+	uint16_t restartIndex = MeshObject::stripRestartIndex;
+	outStrip.clear();
+	outStrip.reserve(countRestartIndices(strips));
+	for (const std::vector<uint16_t>& strip : strips) {
+		if (strip.size() < 3) continue;
+		if (!outStrip.empty()) outStrip.push_back(restartIndex);
+		outStrip.insert(outStrip.end(), strip.begin(), strip.end());
+	}
+}
+
+void StripStitcher::stitch(MeshObject* mesh, StitchMode mode, int drawCallCost)
+{
+	auto start = Timer::begin();
+	std::vector<std::vector<uint16_t>>& strips = mesh->triangleStrips;
+	if (mode == StitchMode::Auto) mode = chooseMode(strips, mesh->vertices.size(), drawCallCost);
+	if (mode == StitchMode::Restart && mesh->vertices.size() > MeshObject::stripRestartIndex) {
+		std::cout << "Vertex " << MeshObject::stripRestartIndex << " is in use, stitching with degenerate triangles instead of restarts" << std::endl;
+		mode = StitchMode::Degenerate;
+	}
+	if (mode == StitchMode::None) return;
+
+	size_t stripCount = strips.size();
+	std::vector<uint16_t> stitched;
+	if (mode == StitchMode::Restart) {
+		stitchRestart(strips, stitched);
+		mesh->primitiveType = MeshObject::PrimitiveType::RestartStrip;
+	}
+	else {
+		stitchDegenerate(strips, stitched);
+		mesh->primitiveType = MeshObject::PrimitiveType::StitchedStrip;
+	}
+	strips.assign(1, std::move(stitched));
+	std::string modeName = mode == StitchMode::Restart ? "restart indices" : "degenerate triangles";
+	Timer::end(start, "Stitched (" + std::to_string(stripCount) + ") strips into (" + std::to_string(strips[0].size()) + ") indices with " + modeName + ": ");
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef SRC_MESHSTRIPER_STRIPSTITCHER_H_
+#define SRC_MESHSTRIPER_STRIPSTITCHER_H_
+
+#include <vector>
+#include <cstdint>
+#include <model/MeshObject.h>
+
+enum class StitchMode {
+	None, // keep the separate strips, one draw call each
+	Degenerate, // join the strips with degenerate triangles, works on any renderer
+	Restart, // join the strips with MeshObject::stripRestartIndex, needs primitive restart enabled
+	Auto // pick whichever costs least for the mesh, see StripStitcher::chooseMode
+};
+
+/// <summary>
+/// <para/>Joins the triangle strips of a mesh into one strip, so the mesh is drawn with a single draw call,
+/// and the file doesn't need a length for every strip.
+/// <para/>Based on Striper::connectAllStrips in src/stripernew.
+/// </summary>
+class StripStitcher {
+public:
+	static const int defaultDrawCallCost = 512;
+
+	/// <summary>
+	/// Number of indices in the single strip made by joining the strips with degenerate triangles.
+	/// </summary>
+	/// <param name="strips">- source strips</param>
+	/// <returns>Index count</returns>
+	static size_t countDegenerateIndices(const std::vector<std::vector<uint16_t>>& strips);
+
+	/// <summary>
+	/// Number of indices in the single strip made by joining the strips with restart indices.
+	/// </summary>
+	/// <param name="strips">- source strips</param>
+	/// <returns>Index count</returns>
+	static size_t countRestartIndices(const std::vector<std::vector<uint16_t>>& strips);
+
+	/// <summary>
+	/// <para/>Cost model: every index costs 1, every draw call costs drawCallCost.
+	/// <para/>Degenerate joins cost 2 indices, 3 when the next strip would otherwise start on an odd triangle and flip its winding.
+	/// Restart joins cost 1 index, but only work while no vertex uses the restart index, so up to 65535 vertices.
+	/// <para/>Ties go to the earlier mode in None, Degenerate, Restart order, so restart is only picked when it saves indices.
+	/// </summary>
+	/// <param name="strips">- source strips</param>
+	/// <param name="vertexCount">- number of vertices the strips index</param>
+	/// <param name="drawCallCost">- cost of a draw call, in indices</param>
+	/// <returns>None, Degenerate or Restart</returns>
+	static StitchMode chooseMode(const std::vector<std::vector<uint16_t>>& strips, size_t vertexCount, int drawCallCost = defaultDrawCallCost);
+
+	/// <summary>
+	/// <para/>Join the strips with 2 repeated indices (the last of one strip and the first of the next), making 4 degenerate triangles.
+	/// <para/>A third repeated index is added when needed so every strip starts on an even triangle, which keeps the winding of its triangles.
+	/// </summary>
+	/// <param name="strips">- source strips</param>
+	/// <param name="outStrip">- joined strip</param>
+	static void stitchDegenerate(const std::vector<std::vector<uint16_t>>& strips, std::vector<uint16_t>& outStrip);
+
+	/// <summary>
+	/// Join the strips with MeshObject::stripRestartIndex between each of them.
+	/// </summary>
+	/// <param name="strips">- source strips</param>
+	/// <param name="outStrip">- joined strip</param>
+	static void stitchRestart(const std::vector<std::vector<uint16_t>>& strips, std::vector<uint16_t>& outStrip);
+
+	/// <summary>
+	/// <para/>Replace the triangle strips of a mesh with one stitched strip, and set the primitive type to match.
+	/// <para/>Run this after VertexReorderer::reorderByFirstUse, which would remap the restart index like a vertex.
+	/// </summary>
+	/// <param name="mesh">- mesh with triangle strips</param>
+	/// <param name="mode">- how to join the strips</param>
+	/// <param name="drawCallCost">- cost of a draw call, in indices, used when mode is Auto</param>
+	static void stitch(MeshObject* mesh, StitchMode mode, int drawCallCost = defaultDrawCallCost);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,322 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <meshstriper/StripTunneler.h>
+#include <util/Timer.hpp>
+
+int StripTunneler::degree(int triangle) const
+{
+	return (links[triangle * 2] != -1) + (links[triangle * 2 + 1] != -1);
+}
+
+bool StripTunneler::isLinked(int triangle, int other) const
+{
+	return links[triangle * 2] == other || links[triangle * 2 + 1] == other;
+}
+
+void StripTunneler::addLink(int triangle, int other)
+{
+	int* a = &links[triangle * 2];
+	int* b = &links[other * 2];
+	a[a[0] == -1 ? 0 : 1] = other;
+	b[b[0] == -1 ? 0 : 1] = triangle;
+}
+
+void StripTunneler::removeLink(int triangle, int other)
+{
+	int* a = &links[triangle * 2];
+	int* b = &links[other * 2];
+	a[a[0] == other ? 0 : 1] = -1;
+	b[b[0] == triangle ? 0 : 1] = -1;
+}
+
+int StripTunneler::sharedEdge(int triangle, int other) const
+{
+	const int* adjacent = triangles[triangle].adjacentTris;
+	for (int k = 0; k < 3; k++) {
+		if (adjacent[k] == other) return k;
+	}
+	return -1;
+}
+
+int StripTunneler::pivot(int triangle) const
+{
+	if (degree(triangle) < 2) return -1;
+	int edge0 = sharedEdge(triangle, links[triangle * 2]);
+	int edge1 = sharedEdge(triangle, links[triangle * 2 + 1]);
+	// edge k runs from vertex k to vertex k + 1, so consecutive edges share the vertex between them
+	if ((edge0 + 1) % 3 == edge1) return triangles[triangle].vertices[edge1];
+	return triangles[triangle].vertices[edge0];
+}
+
+bool StripTunneler::buildLinks(const std::vector<std::vector<uint16_t>>& strips)
+{
+	links.assign((size_t)numTriangles * 2, -1);
+
+	// Triangles around each vertex, to find the first triangle of every strip
+	int vertexCount = 0;
+	for (int t = 0; t < numTriangles; t++) {
+		for (int k = 0; k < 3; k++) vertexCount = std::max(vertexCount, (int)triangles[t].vertices[k] + 1);
+	}
+	std::vector<int> vertexOffsets(vertexCount + 1, 0);
+	for (int t = 0; t < numTriangles; t++) vertexOffsets[triangles[t].vertices[0] + 1]++;
+	for (int v = 0; v < vertexCount; v++) vertexOffsets[v + 1] += vertexOffsets[v];
+	std::vector<int> vertexTriangles(numTriangles);
+	{
+		std::vector<int> fill(vertexOffsets.begin(), vertexOffsets.end() - 1);
+		for (int t = 0; t < numTriangles; t++) vertexTriangles[fill[triangles[t].vertices[0]]++] = t;
+	}
+
+	auto hasVertices = [&](int triangle, uint16_t a, uint16_t b, uint16_t c) {
+		const uint16_t* v = triangles[triangle].vertices;
+		return (v[0] == a || v[0] == b || v[0] == c) && (v[1] == a || v[1] == b || v[1] == c) && (v[2] == a || v[2] == b || v[2] == c)
+			&& a != b && b != c && a != c;
+	};
+
+	std::vector<uint8_t> assigned(numTriangles, 0);
+	for (const std::vector<uint16_t>& strip : strips) {
+		if (strip.size() < 3) return false;
+		const uint16_t* s = strip.data();
+		int current = -1;
+		for (int v = 0; v < 3 && current == -1; v++) {
+			if (s[v] >= vertexCount) return false;
+			for (int i = vertexOffsets[s[v]]; i < vertexOffsets[s[v] + 1]; i++) {
+				int t = vertexTriangles[i];
+				if (!assigned[t] && hasVertices(t, s[0], s[1], s[2])) {
+					current = t;
+					break;
+				}
+			}
+		}
+		if (current == -1) return false;
+		assigned[current] = 1;
+		for (size_t i = 1; i + 2 < strip.size(); i++) {
+			uint16_t v0 = std::min(s[i], s[i + 1]);
+			uint16_t v1 = std::max(s[i], s[i + 1]);
+			int next = triangles[current].adjacentTris[triangles[current].getEdgeIndex(v0, v1)];
+			if (next == -1 || assigned[next] || !hasVertices(next, s[i], s[i + 1], s[i + 2])) return false;
+			assigned[next] = 1;
+			addLink(current, next);
+			current = next;
+		}
+	}
+	return true;
+}
+
+bool StripTunneler::validateTunnel()
+{
+	for (int triangle : pathTriangles) {
+		int trianglePivot = pivot(triangle);
+		if (trianglePivot == -1) continue;
+		for (int j = 0; j < 2; j++) {
+			int other = links[triangle * 2 + j];
+			if (pivot(other) == trianglePivot) return false;
+		}
+	}
+
+	// Walk the strips through the tunnel. A loop comes back to where it started.
+	walkStamp++;
+	for (int triangle : pathTriangles) {
+		if (walkStamps[triangle] == walkStamp) continue;
+		walkStamps[triangle] = walkStamp;
+		for (int j = 0; j < 2; j++) {
+			int previous = triangle;
+			int current = links[triangle * 2 + j];
+			while (current != -1) {
+				if (current == triangle) return false;
+				walkStamps[current] = walkStamp;
+				int next = links[current * 2] == previous ? links[current * 2 + 1] : links[current * 2];
+				previous = current;
+				current = next;
+			}
+		}
+	}
+	return true;
+}
+
+void StripTunneler::flipTunnel(int start, int end)
+{
+	removedLinks.clear();
+	addedLinks.clear();
+	pathTriangles.clear();
+	pathTriangles.push_back(end);
+	int current = end;
+	while (current != start) {
+		int previous = from[current];
+		addedLinks.emplace_back(current, previous);
+		pathTriangles.push_back(previous);
+		if (previous == start) break;
+		current = from[previous];
+		removedLinks.emplace_back(previous, current);
+		pathTriangles.push_back(current);
+	}
+	// Remove first, so no triangle has more than 2 links in between
+	for (const std::pair<int, int>& link : removedLinks) removeLink(link.first, link.second);
+	for (const std::pair<int, int>& link : addedLinks) addLink(link.first, link.second);
+}
+
+void StripTunneler::undoTunnel()
+{
+	for (const std::pair<int, int>& link : addedLinks) removeLink(link.first, link.second);
+	for (const std::pair<int, int>& link : removedLinks) addLink(link.first, link.second);
+}
+
+bool StripTunneler::timeUp()
+{
+	if (!outOfTime && std::chrono::steady_clock::now() > deadline) outOfTime = true;
+	return outOfTime;
+}
+
+bool StripTunneler::tunnelFrom(int start, int maxDepth, int maxVisited)
+{
+	searchStamp++;
+	searchStamps[start] = searchStamp;
+	int visited = 1;
+	int head = 0;
+	int tail = 0;
+
+	// Tunnels leave a triangle over a link that isn't in a strip
+	auto leave = [&](int triangle, int depth) {
+		const int* adjacent = triangles[triangle].adjacentTris;
+		for (int k = 0; k < 3; k++) {
+			int next = adjacent[k];
+			if (next == -1 || searchStamps[next] == searchStamp || isLinked(triangle, next)) continue;
+			searchStamps[next] = searchStamp;
+			from[next] = triangle;
+			depths[next] = depth;
+			queue[tail++] = next;
+			visited++;
+		}
+	};
+
+	leave(start, 0);
+	while (head < tail) {
+		if ((head & 63) == 63 && timeUp()) return false;
+		int triangle = queue[head++];
+		if (degree(triangle) < 2) {
+			flipTunnel(start, triangle);
+			if (validateTunnel()) return true;
+			undoTunnel();
+		}
+		if (depths[triangle] >= maxDepth || visited >= maxVisited) continue;
+		// ...and continue along a link that is
+		for (int j = 0; j < 2; j++) {
+			int next = links[triangle * 2 + j];
+			if (next == -1 || searchStamps[next] == searchStamp) continue;
+			searchStamps[next] = searchStamp;
+			from[next] = triangle;
+			visited++;
+			leave(next, depths[triangle] + 1);
+		}
+	}
+	return false;
+}
+
+void StripTunneler::buildStrip(const std::vector<int>& stripTriangles, std::vector<uint16_t>& strip) const
+{
+	strip.clear();
+	const uint16_t* first = triangles[stripTriangles[0]].vertices;
+	if (stripTriangles.size() == 1) {
+		strip.assign(first, first + 3);
+		return;
+	}
+	int exitEdge = sharedEdge(stripTriangles[0], stripTriangles[1]);
+	uint16_t a = first[(exitEdge + 2) % 3];
+	uint16_t b = first[exitEdge];
+	uint16_t c = first[(exitEdge + 1) % 3];
+	// a, b, c keeps the winding of the first triangle. The second triangle decides which way round b and c go when it has 2 links.
+	int secondPivot = stripTriangles.size() > 2 ? pivot(stripTriangles[1]) : -1;
+	if (secondPivot == b) std::swap(b, c);
+	strip.push_back(a);
+	strip.push_back(b);
+	strip.push_back(c);
+	for (size_t i = 1; i < stripTriangles.size(); i++) {
+		const AdjTriangle& triangle = triangles[stripTriangles[i]];
+		uint16_t v0 = strip[strip.size() - 2];
+		uint16_t v1 = strip[strip.size() - 1];
+		strip.push_back(triangle.getOppositeVertex(v0, v1));
+	}
+}
+
+void StripTunneler::buildStrips(std::vector<std::vector<uint16_t>>& strips)
+{
+	strips.clear();
+	std::vector<uint8_t> done(numTriangles, 0);
+	std::vector<int> stripTriangles;
+	std::vector<uint16_t> forward;
+	std::vector<uint16_t> backward;
+	for (int t = 0; t < numTriangles; t++) {
+		if (done[t] || degree(t) == 2) continue;
+		stripTriangles.clear();
+		int previous = -1;
+		int current = t;
+		while (current != -1) {
+			done[current] = 1;
+			stripTriangles.push_back(current);
+			int next = links[current * 2] == previous ? links[current * 2 + 1] : links[current * 2];
+			previous = current;
+			current = next;
+		}
+		// The strip keeps the winding of its first triangle if b and c were free to swap.
+		// Otherwise it may still keep it when walked from the other end.
+		buildStrip(stripTriangles, forward);
+		const uint16_t* v = triangles[stripTriangles[0]].vertices;
+		auto sameWinding = [&](const uint16_t* s) {
+			for (int r = 0; r < 3; r++) {
+				if (s[0] == v[r] && s[1] == v[(r + 1) % 3]) return true;
+			}
+			return false;
+		};
+		if (!sameWinding(forward.data()) && stripTriangles.size() > 1) {
+			std::reverse(stripTriangles.begin(), stripTriangles.end());
+			buildStrip(stripTriangles, backward);
+			v = triangles[stripTriangles[0]].vertices;
+			if (sameWinding(backward.data())) forward.swap(backward);
+		}
+		strips.push_back(forward);
+	}
+}
+
+int StripTunneler::improve(const AdjTriangle* triangles, int numTriangles, std::vector<std::vector<uint16_t>>& strips, double seconds)
+{
+	auto start = Timer::begin();
+	this->triangles = triangles;
+	this->numTriangles = numTriangles;
+	if (!buildLinks(strips)) {
+		std::cout << "Strips don't follow the triangle adjacency, skipping tunneling" << std::endl;
+		return 0;
+	}
+	searchStamps.assign(numTriangles, 0);
+	walkStamps.assign(numTriangles, 0);
+	from.assign(numTriangles, -1);
+	depths.assign(numTriangles, 0);
+	queue.resize(numTriangles);
+
+	// Single triangles are tried first, they gain the most from joining another strip
+	size_t stripCount = strips.size();
+	int tunnels = 0;
+	bool found = true;
+	outOfTime = false;
+	deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+	while (found && !outOfTime) {
+		found = false;
+		for (int wantedDegree = 0; wantedDegree < 2 && !outOfTime; wantedDegree++) {
+			for (int t = 0; t < numTriangles; t++) {
+				if ((t & 255) == 0 && timeUp()) break;
+				if (degree(t) != wantedDegree) continue;
+				if (tunnelFrom(t, maxTunnelDepth, maxSearchTriangles)) {
+					tunnels++;
+					found = true;
+				}
+				if (outOfTime) break;
+			}
+		}
+	}
+
+	buildStrips(strips);
+	std::cout << "Tunneling joined (" << tunnels << ") strips: " << stripCount << " -> " << strips.size()
+		<< (outOfTime ? " (out of time)" : "") << std::endl;
+	Timer::end(start, "Tunneled strips: ");
+	return tunnels;
+}
\ No newline at end of file
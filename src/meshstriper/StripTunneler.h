@@ -0,0 +1,116 @@
+#ifndef SRC_MESHSTRIPER_STRIPTUNNELER_H_
+#define SRC_MESHSTRIPER_STRIPTUNNELER_H_
+
+#include <vector>
+#include <cstdint>
+#include <chrono>
+#include <meshstriper/MeshStriper.h>
+
+/// <summary>
+/// <para/>Joins triangle strips with the tunneling algorithm (Stewart, "Tunneling for triangle strips in continuous level-of-detail meshes").
+/// <para/>The strips are seen as paths in the dual graph, where every triangle is linked to at most 2 neighbours.
+/// A tunnel is an alternating path between the ends of two strips: a link that isn't in a strip, then one that is, and so on,
+/// ending with a link that isn't. Flipping every link along the tunnel keeps every other triangle's link count,
+/// and adds a link to both ends, so 2 strips become 1.
+/// <para/>A flip is undone if it would make a strip that can't be drawn without swaps (two turns the same way in a row),
+/// or a strip that loops back on itself.
+/// </summary>
+class StripTunneler {
+private:
+	const AdjTriangle* triangles;
+	int numTriangles;
+	std::vector<int> links; // 2 per triangle, the strip neighbours, -1 for none
+	std::vector<int> searchStamps; // last search that visited each triangle
+	std::vector<int> walkStamps; // last validation that walked each triangle
+	std::vector<int> from; // previous triangle on the tunnel, for the current search
+	std::vector<int> depths; // strip links crossed to reach each triangle, for the current search
+	std::vector<int> queue;
+	std::vector<int> pathTriangles;
+	std::vector<std::pair<int, int>> removedLinks;
+	std::vector<std::pair<int, int>> addedLinks;
+	int searchStamp = 0;
+	int walkStamp = 0;
+	std::chrono::steady_clock::time_point deadline;
+	bool outOfTime = false;
+
+	/// <summary>
+	/// Check the clock, and remember when the time budget has run out.
+	/// </summary>
+	bool timeUp();
+
+	int degree(int triangle) const;
+	bool isLinked(int triangle, int other) const;
+	void addLink(int triangle, int other);
+	void removeLink(int triangle, int other);
+
+	/// <summary>
+	/// Edge of a triangle that is shared with another triangle, or -1 if they aren't adjacent.
+	/// </summary>
+	int sharedEdge(int triangle, int other) const;
+
+	/// <summary>
+	/// <para/>Vertex that a strip turns around inside a triangle with 2 links, the vertex shared by both linked edges.
+	/// <para/>Two linked triangles that both have 2 links must turn around different vertices, or the strip would need a swap.
+	/// </summary>
+	/// <returns>Vertex index, or -1 if the triangle has fewer than 2 links</returns>
+	int pivot(int triangle) const;
+
+	/// <summary>
+	/// Turn the strips into links between triangles.
+	/// </summary>
+	/// <param name="strips">- strips made by MeshStriper, without swaps or degenerate triangles</param>
+	/// <returns>False if a strip doesn't follow the adjacency, in which case nothing can be tunneled</returns>
+	bool buildLinks(const std::vector<std::vector<uint16_t>>& strips);
+
+	/// <summary>
+	/// Check the triangles of the last flipped tunnel, and the strips they're in, for swaps and loops.
+	/// </summary>
+	bool validateTunnel();
+
+	/// <summary>
+	/// Flip the links along the tunnel that ends at the given triangle, found by the current search.
+	/// </summary>
+	void flipTunnel(int start, int end);
+	void undoTunnel();
+
+	/// <summary>
+	/// <para/>Breadth first search for the shortest valid tunnel from a strip end to the end of another strip.
+	/// <para/>Validating a tunnel walks whole strips, so the clock is checked every 64 triangles taken off the queue, and the search
+	/// gives up when the time is up.
+	/// </summary>
+	/// <param name="start">- triangle at the end of a strip</param>
+	/// <param name="maxDepth">- maximum number of strip links the tunnel may cross</param>
+	/// <param name="maxVisited">- maximum number of triangles the search may visit</param>
+	/// <returns>True if a tunnel was found and flipped</returns>
+	bool tunnelFrom(int start, int maxDepth, int maxVisited);
+
+	/// <summary>
+	/// Walk the links to make strips. Each strip is walked from the end that keeps the winding of its first triangle, when there is one.
+	/// </summary>
+	/// <param name="strips">- destination strips</param>
+	void buildStrips(std::vector<std::vector<uint16_t>>& strips);
+	void buildStrip(const std::vector<int>& stripTriangles, std::vector<uint16_t>& strip) const;
+public:
+	/// <summary>
+	/// Longest tunnel searched for, in strip links crossed.
+	/// </summary>
+	static const int maxTunnelDepth = 64;
+
+	/// <summary>
+	/// Most triangles visited by one tunnel search.
+	/// </summary>
+	static const int maxSearchTriangles = 4096;
+
+	/// <summary>
+	/// <para/>Reduce the number of strips by tunneling, until no more tunnels are found or the time runs out.
+	/// <para/>Strips are left as they are if they don't follow the adjacency of the triangles.
+	/// </summary>
+	/// <param name="triangles">- linked triangles the strips were made from</param>
+	/// <param name="numTriangles">- number of triangles</param>
+	/// <param name="strips">- strips to improve, replaced by the joined strips</param>
+	/// <param name="seconds">- time budget</param>
+	/// <returns>Number of strips removed</returns>
+	int improve(const AdjTriangle* triangles, int numTriangles, std::vector<std::vector<uint16_t>>& strips, double seconds);
+};
+
+#endif
\ No newline at end of file
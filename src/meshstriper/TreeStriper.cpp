@@ -0,0 +1,183 @@
+#include <string>
+#include <numeric>
+#include <meshstriper/TreeStriper.h>
+#include <util/Timer.hpp>
+
+int TreeStriper::sharedEdge(const AdjTriangle* triangles, int triangle, int other)
+{
+	const int* adjacent = triangles[triangle].adjacentTris;
+	for (int k = 0; k < 3; k++) {
+		if (adjacent[k] == other) return k;
+	}
+	return -1;
+}
+
+void TreeStriper::buildSpanningTree(const AdjTriangle* triangles, int numTriangles, std::vector<int>& parents, std::vector<int>& order)
+{
+	parents.assign(numTriangles, -1);
+	order.clear();
+	order.reserve(numTriangles);
+	std::vector<uint8_t> visited(numTriangles, 0);
+	std::vector<uint8_t> unvisitedNeighbours(numTriangles);
+	for (int t = 0; t < numTriangles; t++) {
+		const int* adjacent = triangles[t].adjacentTris;
+		unvisitedNeighbours[t] = (adjacent[0] != -1) + (adjacent[1] != -1) + (adjacent[2] != -1);
+	}
+
+	// Roots in order of their neighbour count, so trees start at corners and borders
+	std::vector<int> roots(numTriangles);
+	if (options.leastConnectedFirst) {
+		int offsets[5] = { 0, 0, 0, 0, 0 };
+		for (int t = 0; t < numTriangles; t++) offsets[unvisitedNeighbours[t] + 1]++;
+		for (int count = 0; count < 4; count++) offsets[count + 1] += offsets[count];
+		for (int t = 0; t < numTriangles; t++) roots[offsets[unvisitedNeighbours[t]]++] = t;
+	}
+	else {
+		std::iota(roots.begin(), roots.end(), 0);
+	}
+
+	// The last two strip vertices when each triangle is entered. Leaving over the edge from the second of them
+	// to the new vertex needs no swap.
+	std::vector<uint16_t> entries((size_t)numTriangles * 2);
+	std::vector<int> stack;
+	auto visit = [&](int triangle, int parent) {
+		visited[triangle] = 1;
+		parents[triangle] = parent;
+		order.push_back(triangle);
+		const int* adjacent = triangles[triangle].adjacentTris;
+		for (int k = 0; k < 3; k++) {
+			if (adjacent[k] != -1 && !visited[adjacent[k]]) unvisitedNeighbours[adjacent[k]]--;
+		}
+		stack.push_back(triangle);
+	};
+
+	for (int root : roots) {
+		if (visited[root]) continue;
+		entries[root * 2] = triangles[root].vertices[0];
+		entries[root * 2 + 1] = triangles[root].vertices[1];
+		visit(root, -1);
+		while (!stack.empty()) {
+			int triangle = stack.back();
+			const AdjTriangle& current = triangles[triangle];
+			uint16_t p = entries[triangle * 2];
+			uint16_t q = entries[triangle * 2 + 1];
+			uint16_t c = current.getOppositeVertex(p, q);
+			int best = -1;
+			int bestCount = 4;
+			bool bestNatural = false;
+			for (int k = 0; k < 3; k++) {
+				int next = current.adjacentTris[k];
+				if (next == -1 || visited[next]) continue;
+				uint16_t a = current.vertices[k];
+				uint16_t b = current.vertices[(k + 1) % 3];
+				bool natural = (a == q && b == c) || (a == c && b == q);
+				int count = unvisitedNeighbours[next];
+				if (count > bestCount || (count == bestCount && (bestNatural || !natural))) continue;
+				best = next;
+				bestCount = count;
+				bestNatural = natural;
+			}
+			if (best == -1) {
+				stack.pop_back();
+				continue;
+			}
+			entries[best * 2] = bestNatural ? q : p;
+			entries[best * 2 + 1] = c;
+			visit(best, triangle);
+		}
+	}
+}
+
+void TreeStriper::coverPaths(int numTriangles, const std::vector<int>& parents, const std::vector<int>& order, std::vector<int>& links)
+{
+	links.assign((size_t)numTriangles * 2, -1);
+	std::vector<uint8_t> degrees(numTriangles, 0);
+	// Children come after their parents in the visit order, so walking it backwards settles every child before its parent
+	for (int i = (int)order.size() - 1; i >= 0; i--) {
+		int triangle = order[i];
+		int parent = parents[triangle];
+		if (parent == -1 || degrees[triangle] == 2 || degrees[parent] == 2) continue;
+		links[triangle * 2 + degrees[triangle]++] = parent;
+		links[parent * 2 + degrees[parent]++] = triangle;
+	}
+}
+
+int TreeStriper::buildStrip(const AdjTriangle* triangles, const std::vector<int>& path, std::vector<uint16_t>& strip)
+{
+	strip.clear();
+	const uint16_t* first = triangles[path[0]].vertices;
+	if (path.size() == 1) {
+		strip.assign(first, first + 3);
+		return 0;
+	}
+	// Start on the rotation of the first triangle that leaves it over the edge shared with the second, which keeps its winding
+	int exitEdge = sharedEdge(triangles, path[0], path[1]);
+	strip.push_back(first[(exitEdge + 2) % 3]);
+	strip.push_back(first[exitEdge]);
+	strip.push_back(first[(exitEdge + 1) % 3]);
+	int swaps = 0;
+	for (size_t i = 1; i < path.size(); i++) {
+		const AdjTriangle& triangle = triangles[path[i]];
+		uint16_t p = strip[strip.size() - 2];
+		uint16_t q = strip[strip.size() - 1];
+		uint16_t c = triangle.getOppositeVertex(p, q);
+		if (i + 1 < path.size()) {
+			int exit = sharedEdge(triangles, path[i], path[i + 1]);
+			uint16_t a = triangle.vertices[exit];
+			uint16_t b = triangle.vertices[(exit + 1) % 3];
+			// Leaving over (p, c) instead of (q, c): repeat p, so the triangle is drawn as (q, p, c) after a degenerate one
+			if (a != q && b != q) {
+				strip.push_back(p);
+				swaps++;
+			}
+		}
+		strip.push_back(c);
+	}
+	return swaps;
+}
+
+void TreeStriper::setOptions(const StripOptions& options)
+{
+	this->options = options;
+}
+
+bool TreeStriper::striper(MeshObject* mesh)
+{
+	auto start = Timer::begin();
+	int triangleCount = (int)mesh->triangleList.size() / 3;
+	std::vector<AdjTriangle> adjacencies;
+	MeshStriper linker;
+	linker.setOptions(options);
+	linker.createAdjacencies(mesh->triangleList, adjacencies);
+	const AdjTriangle* triangles = adjacencies.data();
+
+	std::vector<int> parents;
+	std::vector<int> order;
+	std::vector<int> links;
+	buildSpanningTree(triangles, triangleCount, parents, order);
+	coverPaths(triangleCount, parents, order, links);
+
+	std::vector<std::vector<uint16_t>>& strips = mesh->triangleStrips;
+	std::vector<uint8_t> done(triangleCount, 0);
+	std::vector<int> path;
+	int swaps = 0;
+	for (int t = 0; t < triangleCount; t++) {
+		if (done[t] || (links[t * 2] != -1 && links[t * 2 + 1] != -1)) continue;
+		path.clear();
+		int previous = -1;
+		int current = t;
+		while (current != -1) {
+			done[current] = 1;
+			path.push_back(current);
+			int next = links[current * 2] == previous ? links[current * 2 + 1] : links[current * 2];
+			previous = current;
+			current = next;
+		}
+		strips.emplace_back();
+		swaps += buildStrip(triangles, path, strips.back());
+	}
+	mesh->primitiveType = MeshObject::PrimitiveType::TriangleStrips;
+	mesh->triangleList.clear();
+	Timer::end(start, "Found (" + std::to_string(strips.size()) + ") triangle strips with (" + std::to_string(swaps) + ") swaps: ");
+	return true;
+}
\ No newline at end of file
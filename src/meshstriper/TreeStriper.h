@@ -0,0 +1,67 @@
+#ifndef SRC_MESHSTRIPER_TREESTRIPER_H_
+#define SRC_MESHSTRIPER_TREESTRIPER_H_
+
+#include <vector>
+#include <cstdint>
+#include <meshstriper/MeshStriper.h>
+
+/// <summary>
+/// <para/>Strips triangles by covering a spanning tree of the dual graph (one node per triangle, one edge per shared edge) with paths.
+/// <para/>The tree is grown depth first, always stepping to the neighbour with the fewest unvisited neighbours left, so it is
+/// made of long chains. The fewest paths that cover it are found bottom up in linear time, and every path becomes one strip.
+/// <para/>A path may turn the same way twice in a row, which a plain strip can't do. Those turns are encoded as swaps:
+/// one repeated index, making a degenerate triangle. The strips keep the winding of every triangle.
+/// </summary>
+class TreeStriper : public StripBackend {
+private:
+	StripOptions options;
+
+	/// <summary>
+	/// Edge of a triangle that is shared with another triangle, or -1 if they aren't adjacent.
+	/// </summary>
+	static int sharedEdge(const AdjTriangle* triangles, int triangle, int other);
+
+	/// <summary>
+	/// <para/>Grow a depth first spanning forest of the dual graph. Each tree is rooted at the unvisited triangle with the fewest
+	/// neighbours when options.leastConnectedFirst is set, or the lowest unvisited triangle otherwise.
+	/// <para/>Ties between neighbours with as many unvisited neighbours are broken in favour of the one a strip can reach without a swap.
+	/// </summary>
+	/// <param name="triangles">- array of linked triangles</param>
+	/// <param name="numTriangles">- number of triangles in array</param>
+	/// <param name="parents">- parent of each triangle, -1 for roots</param>
+	/// <param name="order">- triangles in the order they were visited, so parents come before their children</param>
+	void buildSpanningTree(const AdjTriangle* triangles, int numTriangles, std::vector<int>& parents, std::vector<int>& order);
+
+	/// <summary>
+	/// <para/>Minimum path cover of the spanning forest. Triangles are visited children first, and every triangle is joined to its
+	/// parent while both still have fewer than 2 path links.
+	/// </summary>
+	/// <param name="numTriangles">- number of triangles</param>
+	/// <param name="parents">- parent of each triangle, from buildSpanningTree</param>
+	/// <param name="order">- visit order, from buildSpanningTree</param>
+	/// <param name="links">- 2 per triangle, its neighbours on its path, -1 for none</param>
+	void coverPaths(int numTriangles, const std::vector<int>& parents, const std::vector<int>& order, std::vector<int>& links);
+
+	/// <summary>
+	/// Turn a path of adjacent triangles into a strip, adding a swap wherever the path leaves a triangle over the edge
+	/// that doesn't end with its newest vertex.
+	/// </summary>
+	/// <param name="triangles">- array of linked triangles</param>
+	/// <param name="path">- adjacent triangles in order</param>
+	/// <param name="strip">- destination strip</param>
+	/// <returns>Number of swaps added</returns>
+	static int buildStrip(const AdjTriangle* triangles, const std::vector<int>& path, std::vector<uint16_t>& strip);
+public:
+	const char* getName() const override { return "treestriper"; }
+	void setOptions(const StripOptions& options) override;
+
+	/// <summary>
+	/// <para/>Converts the triangle list of a mesh into an array of generalized triangle strips.
+	/// <para/>The strips are stored in mesh.triangleStrips, and the triangle list is cleared.
+	/// </summary>
+	/// <param name="mesh">- mesh with a triangle list, to put triangle strips into</param>
+	/// <returns>Always true</returns>
+	bool striper(MeshObject* mesh) override;
+};
+
+#endif
\ No newline at end of file
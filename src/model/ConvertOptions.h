@@ -0,0 +1,37 @@
+#ifndef SRC_MODEL_CONVERTOPTIONS_H_
+#define SRC_MODEL_CONVERTOPTIONS_H_
+
+#include <string>
+#include <model/MeshObject.h>
+#include <meshstriper/StripBackend.h>
+#include <meshstriper/StripStitcher.h>
+
+/// <summary>
+/// Settings for converting an fbx file into a model, set from the command line.
+/// </summary>
+struct ConvertOptions {
+	MeshObject::PrimitiveType primitiveType = MeshObject::PrimitiveType::TriangleStrips; // store triangle strips or an indexed triangle list
+	StripBackendType stripBackend = StripBackendType::MeshStriper; // which striper generates the triangle strips
+	bool leastConnectedFirst = true; // start strips at the triangle with the fewest unused neighbours, instead of in index order
+	int speculativeStarts = 0; // start triangles whose strips the striper backend tracks at once in parallel, 0 for one at a time
+	AdjacencyBuilder adjacencyBuilder = AdjacencyBuilder::Auto; // how the strip backends find shared edges: auto, sort or hash
+	float tunnelSeconds = 0.0f; // time spent joining strips by tunneling after they're made, 0 to skip it
+	StitchMode stitchMode = StitchMode::Auto; // join the strips into one strip, with degenerate triangles or restart indices
+	int drawCallCost = StripStitcher::defaultDrawCallCost; // cost of a draw call in indices, used to pick the stitch mode
+	bool buildPrimitives = true; // false stops after simplification, leaving the triangle list as it is, e.g. for benchmarks
+	int cacheSize = 32; // post-transform vertex cache size used to optimize and measure triangle lists and strips
+	bool cacheAwareStrips = false; // grow strips for the vertex cache instead of only for length (meshstriper)
+	std::string previousModel; // .m file converted from an earlier version of the model, its strips are kept where the triangles didn't change
+	bool reorderVertices = true; // renumber vertices and uvs in the order the triangles first use them
+	bool weld = true; // merge duplicate vertices and uv coords before striping
+	float weldEpsilon = 0.0001f; // vertices closer than this are merged
+	float uvWeldEpsilon = 0.00005f; // uv coords closer than this are merged. Half the 1/10000 precision uvs are stored with.
+	bool splitVertices = true; // give each (position, uv, normal) its own vertex so one index buffer addresses every attribute
+	float simplifyRatio = 1.0f; // fraction of the triangles kept by the simplifier, 1 to skip simplification
+	size_t simplifyTriangleCount = 0; // triangles kept by the simplifier, overrides simplifyRatio when not 0
+	float simplifyError = 0.0f; // simplification stops before moving the surface further than this, 0 for no limit
+	bool spatialOrder = true; // sort the triangles along a Morton curve before striping, so neighbouring triangles sit close in memory
+	int threadCount = 0; // threads used by the parallel stages, 0 for one per hardware thread
+};
+
+#endif
\ No newline at end of file
@@ -1,10 +1,20 @@
 #include <iostream>
 #include <string>
 #include <model/FBXReader.h>
-#include <meshstriper/MeshStriper.h>
+#include <model/ModelManager.h>
+#include <meshstriper/IncrementalStriper.h>
+#include <meshstriper/StripBackend.h>
+#include <meshstriper/StripStitcher.h>
+#include <meshoptimizer/CacheOptimizer.h>
+#include <meshoptimizer/Simplifier.h>
+#include <meshoptimizer/TriangleReorderer.h>
+#include <meshoptimizer/VertexReorderer.h>
+#include <meshoptimizer/VertexSplitter.h>
+#include <meshoptimizer/VertexWelder.h>
+#include <util/Parallel.hpp>
 #include <util/Timer.hpp>
 
-bool FBXReader::readFBXModel(const char* path, MeshObject* outMesh)
+bool FBXReader::readFBXModel(const char* path, MeshObject* outMesh, const ConvertOptions& options)
 {
 #if _DEBUG
 	auto start = Timer::begin();
@@ -71,8 +81,11 @@ bool FBXReader::readFBXModel(const char* path, MeshObject* outMesh)
 
 	auto convertStart = Timer::begin();
 	readFBXVertices(mesh, outMesh);
-	readFBXTriangles(mesh, outMesh);
 	readFBXUVs(mesh, outMesh);
+	readFBXNormals(mesh, outMesh);
+	readFBXTriangles(mesh, outMesh, options);
+	if (options.reorderVertices) VertexReorderer::reorderByFirstUse(outMesh);
+	if (outMesh->primitiveType == MeshObject::PrimitiveType::TriangleStrips) StripStitcher::stitch(outMesh, options.stitchMode, options.drawCallCost);
 
 	scene->Destroy();
 	manager->Destroy();
@@ -91,7 +104,7 @@ void FBXReader::readFBXVertices(FbxMesh* mesh, MeshObject* outMesh)
 	int vertexCount = mesh->GetControlPointsCount();
 	std::cout << "[FBX] Detected mesh: '" << mesh->GetName() << "' with vertex count (" << vertexCount << ")" << std::endl;
 	FbxVector4* fbxVertices = mesh->GetControlPoints();
-	outMesh->vertices.reserve(vertexCount);
+	outMesh->vertices.resize(vertexCount);
 	MeshObject::Vertex* meshVertices = outMesh->vertices.data();
 	for (int j = 0; j < vertexCount; ++j) {
 		FbxDouble* vertex = fbxVertices[j].mData;
@@ -103,11 +116,68 @@ void FBXReader::readFBXVertices(FbxMesh* mesh, MeshObject* outMesh)
 #endif
 }
 
-void FBXReader::readFBXTriangles(FbxMesh* mesh, MeshObject* outMesh)
+void FBXReader::readFBXTriangles(FbxMesh* mesh, MeshObject* outMesh, const ConvertOptions& options)
 {
 	std::cout << "[MODELMAKER] Converting..." << std::endl;
-	MeshStriper striper;
-	striper.striper(mesh, outMesh);
+	int* vertices = mesh->GetPolygonVertices();
+	outMesh->triangleList.assign(vertices, vertices + (size_t)mesh->GetPolygonCount() * 3);
+	if (options.weld) {
+		VertexWelder::weldVertices(outMesh, options.weldEpsilon, options.threadCount);
+		VertexWelder::weldUVs(outMesh, options.uvWeldEpsilon, options.threadCount);
+	}
+	// meshes that would get too many vertices keep their uvs separate, like with --separate-uvs
+	if (!options.splitVertices || !VertexSplitter::splitVertices(outMesh)) VertexSplitter::applyCornerNormals(outMesh);
+	size_t triangleCount = outMesh->triangleList.size() / 3;
+	size_t targetTriangleCount = options.simplifyTriangleCount ? options.simplifyTriangleCount : (size_t)(triangleCount * (double)options.simplifyRatio);
+	if (options.simplifyError > 0.0f && !options.simplifyTriangleCount && options.simplifyRatio >= 1.0f) targetTriangleCount = 0; // only bounded by the error
+	if (targetTriangleCount < triangleCount) Simplifier::simplify(outMesh, targetTriangleCount, options.simplifyError, options.threadCount);
+	if (options.spatialOrder) TriangleReorderer::reorderSpatially(outMesh, options.threadCount);
+	if (!options.buildPrimitives) {
+		outMesh->primitiveType = MeshObject::PrimitiveType::TriangleList;
+		return;
+	}
+	if (options.primitiveType == MeshObject::PrimitiveType::TriangleList) {
+		buildTriangleList(outMesh, options);
+		return;
+	}
+	StripOptions stripOptions;
+	stripOptions.threadCount = Parallel::threadCount(options.threadCount);
+	stripOptions.leastConnectedFirst = options.leastConnectedFirst;
+	stripOptions.speculativeStarts = options.speculativeStarts;
+	stripOptions.tunnelSeconds = options.tunnelSeconds;
+	stripOptions.adjacencyBuilder = options.adjacencyBuilder;
+	if (options.cacheAwareStrips) stripOptions.cacheSize = options.cacheSize;
+	bool restriped = false;
+	if (!options.previousModel.empty()) {
+		MeshObject previous;
+		bool readable = std::ifstream(options.previousModel, std::ios::binary).good() && ModelManager::readModel(options.previousModel.c_str(), &previous);
+		restriped = readable && IncrementalStriper::restripe(outMesh, previous, stripOptions, options.stripBackend);
+		if (!restriped) std::cout << "Can't reuse the strips of '" << options.previousModel << "', striping the whole mesh" << std::endl;
+	}
+	if (!restriped) {
+		std::unique_ptr<StripBackend> backend = StripBackend::create(options.stripBackend, stripOptions);
+		if (!backend->striper(outMesh)) {
+			std::cout << "Falling back to meshstriper" << std::endl;
+			StripBackend::create(StripBackendType::MeshStriper, stripOptions)->striper(outMesh);
+		}
+	}
+	std::cout << "Strips: " << outMesh->triangleStrips.size() << ", ACMR: "
+		<< CacheOptimizer::computeStripACMR(outMesh->triangleStrips, outMesh->vertices.size(), options.cacheSize) << std::endl;
+}
+
+void FBXReader::buildTriangleList(MeshObject* outMesh, const ConvertOptions& options)
+{
+	auto start = Timer::begin();
+	size_t triangleCount = outMesh->triangleList.size() / 3;
+	size_t vertexCount = outMesh->vertices.size();
+	outMesh->primitiveType = MeshObject::PrimitiveType::TriangleList;
+
+	std::cout << "ACMR/ATVR before: " << CacheOptimizer::computeACMR(outMesh->triangleList, vertexCount, options.cacheSize)
+		<< "/" << CacheOptimizer::computeATVR(outMesh->triangleList, vertexCount, options.cacheSize) << std::endl;
+	CacheOptimizer::optimizeForsyth(outMesh->triangleList, vertexCount, options.cacheSize);
+	std::cout << "ACMR/ATVR after: " << CacheOptimizer::computeACMR(outMesh->triangleList, vertexCount, options.cacheSize)
+		<< "/" << CacheOptimizer::computeATVR(outMesh->triangleList, vertexCount, options.cacheSize) << std::endl;
+	Timer::end(start, "Built (" + std::to_string(triangleCount) + ") triangle list: ");
 }
 
 void FBXReader::readFBXUVs(FbxMesh* mesh, MeshObject* outMesh)
@@ -143,4 +213,27 @@ void FBXReader::readFBXUVs(FbxMesh* mesh, MeshObject* outMesh)
 #if _DEBUG
 	Timer::end(start, "Found (" + std::to_string(outMesh->uvs.size()) + ") uv's: ");
 #endif
+}
+
+void FBXReader::readFBXNormals(FbxMesh* mesh, MeshObject* outMesh)
+{
+#if _DEBUG
+	auto start = Timer::begin();
+#endif
+
+	int polygonCount = mesh->GetPolygonCount();
+	outMesh->cornerNormals.resize((size_t)polygonCount * 3);
+	MeshObject::Normal* cornerNormals = outMesh->cornerNormals.data();
+	FbxVector4 normal;
+	for (int i = 0; i < polygonCount; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			if (!mesh->GetPolygonVertexNormal(i, j, normal)) continue;
+			FbxDouble* n = normal.mData;
+			cornerNormals[i * 3 + j] = MeshObject::Normal((float)n[0], (float)n[1], (float)n[2]);
+		}
+	}
+
+#if _DEBUG
+	Timer::end(start, "Found (" + std::to_string(outMesh->cornerNormals.size()) + ") corner normals: ");
+#endif
 }
\ No newline at end of file
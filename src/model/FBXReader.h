@@ -4,6 +4,7 @@
 #include <vector>
 #include <fbxsdk.h>
 #include <model/MeshObject.h>
+#include <model/ConvertOptions.h>
 
 class FBXReader {
 public:
@@ -16,8 +17,9 @@ public:
 	/// </summary>
 	/// <param name="path">- souce filepath to read from</param>
 	/// <param name="outMesh">- destination mesh to write to</param>
+	/// <param name="options">- conversion settings</param>
 	/// <returns>Read success</returns>
-	static bool readFBXModel(const char* path, MeshObject* outMesh);
+	static bool readFBXModel(const char* path, MeshObject* outMesh, const ConvertOptions& options = ConvertOptions());
 private:
 	/// <summary>
 	/// Loop through vertices and stick 'em into the vertex vector
@@ -27,11 +29,25 @@ private:
 	static void readFBXVertices(FbxMesh* mesh, MeshObject* outMesh);
 
 	/// <summary>
-	/// Loop through the polygons and generate triangle strips, uv strips and a normal list
+	/// <para/>Copy the polygons into outMesh.triangleList, weld duplicate vertices and uv coords, split vertices on
+	/// (position, uv, normal), simplify, sort the triangles spatially,
+	/// then generate triangle strips with options.stripBackend, or a triangle list, depending on options.primitiveType.
+	/// <para/>If the strip backend fails, meshstriper is used instead. The strip count and ACMR are reported.
+	/// <para/>With options.previousModel set, the strips of that file are kept where the triangles didn't change, see IncrementalStriper.
+	/// <para/>Must run after readFBXVertices, readFBXUVs and readFBXNormals.
 	/// </summary>
 	/// <param name="mesh">- source mesh to read from</param>
 	/// <param name="outMesh">- destination mesh to write to</param>
-	static void readFBXTriangles(FbxMesh* mesh, MeshObject* outMesh);
+	/// <param name="options">- conversion settings</param>
+	static void readFBXTriangles(FbxMesh* mesh, MeshObject* outMesh, const ConvertOptions& options);
+
+	/// <summary>
+	/// Reorder outMesh.triangleList for the post-transform vertex cache.
+	/// ACMR and ATVR are reported before and after.
+	/// </summary>
+	/// <param name="outMesh">- mesh with a triangle list</param>
+	/// <param name="options">- conversion settings</param>
+	static void buildTriangleList(MeshObject* outMesh, const ConvertOptions& options);
 
 	/// <summary>
 	/// Read uv coords for each triangle.
@@ -39,6 +55,13 @@ private:
 	/// <param name="mesh">- source mesh to read from</param>
 	/// <param name="outMesh">- destination mesh to write to</param>
 	static void readFBXUVs(FbxMesh* mesh, MeshObject* outMesh);
+
+	/// <summary>
+	/// Read the normal of each triangle corner into outMesh.cornerNormals.
+	/// </summary>
+	/// <param name="mesh">- source mesh to read from</param>
+	/// <param name="outMesh">- destination mesh to write to</param>
+	static void readFBXNormals(FbxMesh* mesh, MeshObject* outMesh);
 };
 
 #endif
\ No newline at end of file
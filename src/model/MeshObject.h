@@ -8,6 +8,15 @@ class MeshObject {
 public:
 	int sizeondisk = 0;
 
+	enum class PrimitiveType : uint8_t {
+		TriangleStrips = 0, // triangles are stored in triangleStrips
+		TriangleList = 1, // triangles are stored in triangleList, 3 indices per triangle
+		StitchedStrip = 2, // triangleStrips holds a single strip, the original strips joined by degenerate triangles
+		RestartStrip = 3 // triangleStrips holds a single strip, the original strips separated by stripRestartIndex
+	};
+
+	static const uint16_t stripRestartIndex = 0xFFFF; // primitive restart value in RestartStrip strips. Never a vertex index there.
+
 	struct Normal {
 		float x = 0;
 		float y = 0;
@@ -57,9 +66,12 @@ public:
 	};
 
 	std::vector<Vertex> vertices;
+	PrimitiveType primitiveType = PrimitiveType::TriangleStrips;
 	std::vector<std::vector<uint16_t>> triangleStrips;
-	std::vector<float> uvs;
-	std::vector<int> uvIndexes;
+	std::vector<uint32_t> triangleList;
+	std::vector<float> uvs; // 2 floats per uv coord. One per vertex when uvIndexes is empty.
+	std::vector<int> uvIndexes; // uv coord of each triangle corner, empty once vertices are split
+	std::vector<Normal> cornerNormals; // normal of each triangle corner, empty once normals are on the vertices
 };
 
 #endif
\ No newline at end of file
@@ -1,12 +1,13 @@
 #include <iostream>
 #include <model/ModelManager.h>
+#include <model/StripExpander.h>
 #include <util/Timer.hpp>
 
 void ModelManager::compare(MeshObject* meshA, MeshObject* meshB) {
 	auto start = Timer::begin();
 	//compare vertices
-	int meshAVerts = (int)meshA->vertices.capacity();
-	int meshBVerts = (int)meshB->vertices.capacity();
+	int meshAVerts = (int)meshA->vertices.size();
+	int meshBVerts = (int)meshB->vertices.size();
 	std::cout << "Vertices: " << meshAVerts << "/" << meshBVerts << ", ";
 	int numCorrect = 0;
 	MeshObject::Vertex* verticesa = meshA->vertices.data();
@@ -37,6 +38,21 @@ void ModelManager::compare(MeshObject* meshA, MeshObject* meshB) {
 	}
 	std::cout << ((float)numCorrect / (float)numIndices) * 100 << "% accurate" << std::endl;
 
+	// compare triangle list
+	int meshATriListLength = (int)meshA->triangleList.size();
+	int meshBTriListLength = (int)meshB->triangleList.size();
+	if (meshBTriListLength > 0) {
+		std::cout << "Triangle list: " << meshATriListLength << "/" << meshBTriListLength << ", ";
+		if (meshATriListLength != meshBTriListLength) return;
+		numCorrect = 0;
+		uint32_t* meshAList = meshA->triangleList.data();
+		uint32_t* meshBList = meshB->triangleList.data();
+		for (int i = 0; i < meshBTriListLength; i++) {
+			if (meshAList[i] == meshBList[i]) numCorrect++;
+		}
+		std::cout << ((float)numCorrect / (float)meshBTriListLength) * 100 << "% accurate" << std::endl;
+	}
+
 	// compare uv strips
 	int uvsA = (int)meshA->uvs.size();
 	int uvsB = (int)meshB->uvs.size();
@@ -64,20 +80,60 @@ void ModelManager::compare(MeshObject* meshA, MeshObject* meshB) {
 	Timer::end(start, "Comparison: ");
 }
 
-void ModelManager::readModel(const char* path, MeshObject* outMesh)
+bool ModelManager::readModel(const char* path, MeshObject* outMesh)
 {
 	auto start = Timer::begin();
 #if _DEBUG
 	Timer::end(start, "Created empty mesh: ");
 #endif
 	std::ifstream file(path, std::ios::binary);
+	if (!readHeader(file, path)) return false;
+	readVertices(file, outMesh);
+	MeshObject::PrimitiveType type;
+	if (!readPrimitiveType(file, type)) return false;
+	readIndices(file, type, outMesh);
+	readUVs(file, outMesh);
+	readVertexNormals(file, outMesh);
+	if (!file) {
+		std::cout << "'" << path << "' ends early" << std::endl;
+		return false;
+	}
+	file.close();
+	Timer::end(start, "[MODELMAKER] Read model: ");
+	std::flush(std::cout);
+	return true;
+}
+
+bool ModelManager::readModel(const char* path, MeshObject* outMesh, IndexOutput& indexOutput)
+{
+	auto start = Timer::begin();
+	indexOutput.count = 0;
+	std::ifstream file(path, std::ios::binary);
+	if (!readHeader(file, path)) return false;
 	readVertices(file, outMesh);
-	readTriangleStrips(file, outMesh);
+	MeshObject::PrimitiveType type;
+	if (!readPrimitiveType(file, type)) return false;
+	bool fits = readIndices(file, type, indexOutput);
 	readUVs(file, outMesh);
 	readVertexNormals(file, outMesh);
+	if (!file) {
+		std::cout << "'" << path << "' ends early" << std::endl;
+		indexOutput.count = 0;
+		return false;
+	}
 	file.close();
 	Timer::end(start, "[MODELMAKER] Read model: ");
 	std::flush(std::cout);
+	return fits;
+}
+
+bool ModelManager::readHeader(std::ifstream& file, const char* path)
+{
+	uint32_t magic = 0;
+	file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	if (file && magic == fileMagic) return true;
+	std::cout << "'" << path << "' isn't a model file, or was written by an older version without the MDL1 header" << std::endl;
+	return false;
 }
 
 void ModelManager::readVertices(std::ifstream& file, MeshObject* mesh)
@@ -130,6 +186,174 @@ void ModelManager::readTriangleStrips(std::ifstream& file, MeshObject* mesh)
 #endif
 }
 
+bool ModelManager::readPrimitiveType(std::ifstream& file, MeshObject::PrimitiveType& type)
+{
+	int primitiveType = file.get();
+	if (primitiveType < 0 || primitiveType > (int)MeshObject::PrimitiveType::RestartStrip) {
+		std::cout << "Unknown primitive type " << primitiveType << std::endl;
+		return false;
+	}
+	type = (MeshObject::PrimitiveType)primitiveType;
+	return true;
+}
+
+void ModelManager::readIndices(std::ifstream& file, MeshObject::PrimitiveType type, MeshObject* mesh)
+{
+	mesh->primitiveType = type;
+	if (type == MeshObject::PrimitiveType::TriangleList) readTriangleList(file, mesh);
+	else if (type == MeshObject::PrimitiveType::TriangleStrips) readTriangleStrips(file, mesh);
+	else readStitchedStrip(file, mesh);
+}
+
+bool ModelManager::readIndices(std::ifstream& file, MeshObject::PrimitiveType type, IndexOutput& indexOutput)
+{
+	if (type == MeshObject::PrimitiveType::TriangleList) return readTriangleList(file, indexOutput);
+	if (type == MeshObject::PrimitiveType::TriangleStrips) return readTriangleStrips(file, indexOutput);
+	return readStitchedStrip(file, indexOutput, type == MeshObject::PrimitiveType::RestartStrip);
+}
+
+void ModelManager::readTriangleList(std::ifstream& file, MeshObject* mesh)
+{
+#if _DEBUG
+	auto start = Timer::begin();
+#endif
+	char metadataBuffer[4];
+	file.read(metadataBuffer, sizeof(metadataBuffer));
+	int numIndices = *reinterpret_cast<int*>(&metadataBuffer);
+	std::vector<uint16_t> buffer(numIndices);
+	file.read(reinterpret_cast<char*>(buffer.data()), 2 * (size_t)numIndices);
+	mesh->triangleList.assign(buffer.begin(), buffer.end());
+#if _DEBUG
+	Timer::end(start, "Read (" + std::to_string(numIndices / 3) + ") triangles: ");
+#endif
+}
+
+bool ModelManager::readTriangleList(std::ifstream& file, IndexOutput& indexOutput)
+{
+	char metadataBuffer[4];
+	file.read(metadataBuffer, sizeof(metadataBuffer));
+	int numIndices = *reinterpret_cast<int*>(&metadataBuffer);
+	indexOutput.mode = IndexOutputMode::TriangleList;
+	indexOutput.count = numIndices;
+	if ((size_t)numIndices > indexOutput.capacity || (!indexOutput.indices16 && !indexOutput.indices32)) {
+		file.seekg(2 * (std::streamoff)numIndices, std::ios::cur);
+		return false;
+	}
+	if (indexOutput.indices16) {
+		file.read(reinterpret_cast<char*>(indexOutput.indices16), 2 * (size_t)numIndices);
+	}
+	else {
+		std::vector<uint16_t> buffer(numIndices);
+		file.read(reinterpret_cast<char*>(buffer.data()), 2 * (size_t)numIndices);
+		std::copy(buffer.begin(), buffer.end(), indexOutput.indices32);
+	}
+	return true;
+}
+
+bool ModelManager::readTriangleStrips(std::ifstream& file, IndexOutput& indexOutput)
+{
+#if _DEBUG
+	auto start = Timer::begin();
+#endif
+	char metadataBuffer[2];
+	char stripSizeBuffer[2];
+	std::vector<uint16_t> strip;
+	file.read(metadataBuffer, sizeof(metadataBuffer));
+	uint16_t numTriStrips = *reinterpret_cast<uint16_t*>(&metadataBuffer);
+	bool restart = indexOutput.mode == IndexOutputMode::RestartStrip;
+	bool fits = indexOutput.indices16 != nullptr || indexOutput.indices32 != nullptr;
+	size_t count = 0;
+	for (int i = 0; i < numTriStrips; ++i) {
+		file.read(stripSizeBuffer, sizeof(stripSizeBuffer));
+		uint16_t stripSize = *reinterpret_cast<uint16_t*>(&stripSizeBuffer);
+		strip.resize(stripSize);
+		file.read(reinterpret_cast<char*>(strip.data()), 2 * (size_t)stripSize);
+
+		size_t numIndices;
+		if (restart) numIndices = stripSize + (i > 0 ? 1 : 0);
+		else numIndices = stripSize >= 3 ? ((size_t)stripSize - 2) * 3 : 0;
+		if (count + numIndices > indexOutput.capacity) fits = false;
+		if (fits) {
+			if (indexOutput.indices16) {
+				uint16_t* out = indexOutput.indices16 + count;
+				if (!restart) StripExpander::expandStrip(strip.data(), stripSize, out);
+				else {
+					if (i > 0) *out++ = (uint16_t)indexOutput.restartIndex;
+					memcpy(out, strip.data(), 2 * (size_t)stripSize);
+				}
+			}
+			else {
+				uint32_t* out = indexOutput.indices32 + count;
+				if (!restart) StripExpander::expandStrip(strip.data(), stripSize, out);
+				else {
+					if (i > 0) *out++ = indexOutput.restartIndex;
+					for (int j = 0; j < stripSize; j++) out[j] = strip[j];
+				}
+			}
+		}
+		count += numIndices;
+	}
+	indexOutput.count = count;
+#if _DEBUG
+	Timer::end(start, "Read (" + std::to_string(numTriStrips) + ") triangle strips into (" + std::to_string(count) + ") indices: ");
+#endif
+	return fits;
+}
+
+void ModelManager::readStitchedStrip(std::ifstream& file, MeshObject* mesh)
+{
+#if _DEBUG
+	auto start = Timer::begin();
+#endif
+	char metadataBuffer[4];
+	file.read(metadataBuffer, sizeof(metadataBuffer));
+	int numIndices = *reinterpret_cast<int*>(&metadataBuffer);
+	mesh->triangleStrips.resize(1);
+	std::vector<uint16_t>& strip = mesh->triangleStrips[0];
+	strip.resize(numIndices);
+	file.read(reinterpret_cast<char*>(strip.data()), 2 * (size_t)numIndices);
+#if _DEBUG
+	Timer::end(start, "Read stitched strip (" + std::to_string(numIndices) + " indices): ");
+#endif
+}
+
+bool ModelManager::readStitchedStrip(std::ifstream& file, IndexOutput& indexOutput, bool restart)
+{
+#if _DEBUG
+	auto start = Timer::begin();
+#endif
+	char metadataBuffer[4];
+	file.read(metadataBuffer, sizeof(metadataBuffer));
+	int numIndices = *reinterpret_cast<int*>(&metadataBuffer);
+	std::vector<uint16_t> strip(numIndices);
+	file.read(reinterpret_cast<char*>(strip.data()), 2 * (size_t)numIndices);
+
+	bool expand = indexOutput.mode == IndexOutputMode::TriangleList;
+	if (expand) indexOutput.count = StripExpander::countStitchedTriangleListIndices(strip.data(), strip.size(), restart, MeshObject::stripRestartIndex);
+	else indexOutput.count = numIndices;
+	if (indexOutput.count > indexOutput.capacity || (!indexOutput.indices16 && !indexOutput.indices32)) return false;
+
+	if (expand) {
+		if (indexOutput.indices16) StripExpander::expandStitchedStrip(strip.data(), strip.size(), restart, indexOutput.indices16, MeshObject::stripRestartIndex);
+		else StripExpander::expandStitchedStrip(strip.data(), strip.size(), restart, indexOutput.indices32, MeshObject::stripRestartIndex);
+	}
+	else if (indexOutput.indices16) {
+		uint16_t restartIndex = (uint16_t)indexOutput.restartIndex;
+		for (int i = 0; i < numIndices; i++) {
+			indexOutput.indices16[i] = restart && strip[i] == MeshObject::stripRestartIndex ? restartIndex : strip[i];
+		}
+	}
+	else {
+		for (int i = 0; i < numIndices; i++) {
+			indexOutput.indices32[i] = restart && strip[i] == MeshObject::stripRestartIndex ? indexOutput.restartIndex : strip[i];
+		}
+	}
+#if _DEBUG
+	Timer::end(start, "Read stitched strip into (" + std::to_string(indexOutput.count) + ") indices: ");
+#endif
+	return true;
+}
+
 void ModelManager::readUVs(std::ifstream& file, MeshObject* mesh)
 {
 #if _DEBUG
@@ -151,8 +375,7 @@ void ModelManager::readUVs(std::ifstream& file, MeshObject* mesh)
 	}
 
 	// uv indexes
-	unsigned char markerByte;
-	file >> markerByte;
+	int markerByte = file.get();
 	char metadataBuffer2[4];
 	file.read(metadataBuffer2, sizeof(metadataBuffer2));
 	int numUVIndexes = *reinterpret_cast<int*>(&metadataBuffer2);
@@ -212,19 +435,27 @@ void ModelManager::writeToDisk(MeshObject* mesh, std::string filename)
 {
 	auto start = Timer::begin();
 	std::ofstream modelFile(filename, std::ios::out | std::ios::binary);
+	writeHeader(mesh, modelFile);
 	writeVertices(mesh, modelFile);
-	writeTriangleStrips(mesh, modelFile);
+	writeIndices(mesh, modelFile);
 	writeUVs(mesh, modelFile);
 	writeVertexNormals(mesh, modelFile);
 	Timer::end(start, "[MODELMAKER] Wrote model to disk (" + std::to_string(mesh->sizeondisk) + " bytes): ");
 }
 
+void ModelManager::writeHeader(MeshObject* mesh, std::ofstream& file)
+{
+	uint32_t magic = fileMagic;
+	file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+	mesh->sizeondisk += sizeof(magic);
+}
+
 void ModelManager::writeVertices(MeshObject* mesh, std::ofstream& file)
 {
 #if _DEBUG
 	auto start = Timer::begin();
 #endif
-	int numVertices = (int)mesh->vertices.capacity();
+	int numVertices = (int)mesh->vertices.size();
 	file.write(reinterpret_cast<const char*>(&numVertices), 2);
 	std::vector<float> values(numVertices * 3);
 	float* ptr = values.data();
@@ -240,7 +471,7 @@ void ModelManager::writeVertices(MeshObject* mesh, std::ofstream& file)
 	int numBytes = 2 + (numVertices * 12);
 	mesh->sizeondisk += numBytes;
 #if _DEBUG
-	Timer::end(start, "Wrote (" + std::to_string(mesh->vertices.capacity()) + ") vertices (" + std::to_string(numBytes) + " bytes): ");
+	Timer::end(start, "Wrote (" + std::to_string(mesh->vertices.size()) + ") vertices (" + std::to_string(numBytes) + " bytes): ");
 #endif
 }
 
@@ -267,6 +498,46 @@ void ModelManager::writeTriangleStrips(MeshObject* mesh, std::ofstream& file)
 #endif
 }
 
+void ModelManager::writeIndices(MeshObject* mesh, std::ofstream& file)
+{
+	file.put((char)mesh->primitiveType);
+	mesh->sizeondisk += 1;
+	if (mesh->primitiveType == MeshObject::PrimitiveType::TriangleList) writeTriangleList(mesh, file);
+	else if (mesh->primitiveType == MeshObject::PrimitiveType::TriangleStrips) writeTriangleStrips(mesh, file);
+	else writeStitchedStrip(mesh, file);
+}
+
+void ModelManager::writeTriangleList(MeshObject* mesh, std::ofstream& file)
+{
+#if _DEBUG
+	auto start = Timer::begin();
+#endif
+	int numIndices = (int)mesh->triangleList.size();
+	file.write(reinterpret_cast<const char*>(&numIndices), 4);
+	std::vector<uint16_t> shorts(mesh->triangleList.begin(), mesh->triangleList.end());
+	file.write(reinterpret_cast<const char*>(shorts.data()), 2 * shorts.size());
+	int numBytes = 4 + (numIndices * 2);
+	mesh->sizeondisk += numBytes;
+#if _DEBUG
+	Timer::end(start, "Wrote (" + std::to_string(numIndices / 3) + ") triangles (" + std::to_string(numBytes) + " bytes): ");
+#endif
+}
+
+void ModelManager::writeStitchedStrip(MeshObject* mesh, std::ofstream& file)
+{
+#if _DEBUG
+	auto start = Timer::begin();
+#endif
+	int numIndices = mesh->triangleStrips.empty() ? 0 : (int)mesh->triangleStrips[0].size();
+	file.write(reinterpret_cast<const char*>(&numIndices), 4);
+	if (numIndices > 0) file.write(reinterpret_cast<const char*>(mesh->triangleStrips[0].data()), 2 * (size_t)numIndices);
+	int numBytes = 4 + (numIndices * 2);
+	mesh->sizeondisk += numBytes;
+#if _DEBUG
+	Timer::end(start, "Wrote stitched strip (" + std::to_string(numIndices) + " indices, " + std::to_string(numBytes) + " bytes): ");
+#endif
+}
+
 void ModelManager::writeUVs(MeshObject* mesh, std::ofstream& file)
 {
 #if _DEBUG
@@ -290,7 +561,7 @@ void ModelManager::writeUVs(MeshObject* mesh, std::ofstream& file)
 	int* uvIndices = mesh->uvIndexes.data();
 	if (numUVs <= 65536) {
 		// if the number of uvs is less than 65536, then the indexes can fit into 2 bytes
-		file << 0x00; // marker byte
+		file.put(0); // marker byte
 		file.write(reinterpret_cast<const char*>(&numUVIndexes), 4);
 		std::vector<uint16_t> shorts(numUVIndexes);
 		uint16_t* shortsPtr = shorts.data();
@@ -304,7 +575,7 @@ void ModelManager::writeUVs(MeshObject* mesh, std::ofstream& file)
 	}
 	else {
 		// if the number of uvs is more than 65536, then the indexes have to be 4 bytes each
-		file << 0x01; // marker byte
+		file.put(1); // marker byte
 		file.write(reinterpret_cast<const char*>(&numUVIndexes), 4);
 		file.write(reinterpret_cast<const char*>(uvIndices), numUVIndexes * sizeof(int));
 		numBytes += 5 + (numUVIndexes * 4);
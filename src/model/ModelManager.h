@@ -7,14 +7,50 @@
 #include <fbxsdk.h>
 #include <model/MeshObject.h>
 
+enum class IndexOutputMode {
+	TriangleList, // strips are expanded to a triangle list, 3 indices per triangle
+	RestartStrip // strips are concatenated into one strip, separated by restartIndex. Stitched strips are copied as they are.
+};
+
+/// <summary>
+/// <para/>Caller supplied index buffer that the triangle strips of a model are written into while the model is read.
+/// <para/>Set indices16 or indices32, depending on the index size the renderer wants.
+/// </summary>
+struct IndexOutput {
+	IndexOutputMode mode = IndexOutputMode::TriangleList;
+	uint16_t* indices16 = nullptr; // destination for 2 byte indices, or null
+	uint32_t* indices32 = nullptr; // destination for 4 byte indices, or null
+	size_t capacity = 0; // number of indices the destination can hold
+	uint32_t restartIndex = 0xFFFFFFFF; // truncated to 0xFFFF for 2 byte indices
+	size_t count = 0; // number of indices in the model. Set even if they don't fit in the destination.
+};
+
 class ModelManager {
 public:
+	/// <summary>
+	/// First 4 bytes of every model file: "MDL1" in little endian, the format name and version.
+	/// Files without it were written before the primitive type byte existed, and can't be read.
+	/// </summary>
+	static const uint32_t fileMagic = 0x314C444D;
+
 	/// <summary>
 	/// Read model file
 	/// </summary>
 	/// <param name="path">- filepath to model</param>
 	/// <param name="outMesh">- destination mesh to write to</param>
-	static void readModel(const char* path, MeshObject* outMesh);
+	/// <returns>False if the file doesn't start with fileMagic, has an unknown primitive type or ends early</returns>
+	static bool readModel(const char* path, MeshObject* outMesh);
+
+	/// <summary>
+	/// <para/>Read model file, writing the triangles straight into the caller's index buffer instead of outMesh.triangleStrips.
+	/// <para/>If the buffer is too small, nothing more is written to it, but indexOutput.count is still set to the number of indices needed.
+	/// <para/>Models stored as a triangle list are always written as a triangle list, and indexOutput.mode is set to match.
+	/// </summary>
+	/// <param name="path">- filepath to model</param>
+	/// <param name="outMesh">- destination mesh to write vertices, uvs and normals to</param>
+	/// <param name="indexOutput">- destination index buffer and output mode</param>
+	/// <returns>True if every index fit in the destination buffer. False with indexOutput.count 0 if the file can't be read.</returns>
+	static bool readModel(const char* path, MeshObject* outMesh, IndexOutput& indexOutput);
 
 	/// <summary>
 	/// Write MeshObject to file
@@ -24,6 +60,14 @@ public:
 	static void writeToDisk(MeshObject* mesh, std::string filename);
 	static void compare(MeshObject* meshA, MeshObject* meshB);
 private:
+	/// <summary>
+	/// Check that the file starts with fileMagic, and print why it can't be read if it doesn't.
+	/// </summary>
+	/// <param name="file">- source file to read from</param>
+	/// <param name="path">- filepath, for the message</param>
+	/// <returns>True if the header matches</returns>
+	static bool readHeader(std::ifstream& file, const char* path);
+
 	/// <summary>
 	/// File is read in chunks to reduce overhead from file::read. Maximum chunksize seems to be 64, meaning 64 vertices are read at a time.
 	/// The remaining vertices are read 1 by 1 at the end.
@@ -41,10 +85,63 @@ private:
 	/// <param name="mesh">- destination mesh to write to</param>
 	static void readTriangleStrips(std::ifstream& file, MeshObject* mesh);
 
+	/// <summary>
+	/// Read the primitive type byte.
+	/// </summary>
+	/// <param name="file">- source file to read from</param>
+	/// <param name="type">- set to the primitive type</param>
+	/// <returns>False if it isn't one of the 4 known types</returns>
+	static bool readPrimitiveType(std::ifstream& file, MeshObject::PrimitiveType& type);
+
+	/// <summary>
+	/// Read the triangle strips or triangle list that follow the primitive type byte.
+	/// </summary>
+	/// <param name="file">- source file to read from</param>
+	/// <param name="type">- primitive type read by readPrimitiveType</param>
+	/// <param name="mesh">- destination mesh to write to</param>
+	static void readIndices(std::ifstream& file, MeshObject::PrimitiveType type, MeshObject* mesh);
+	static bool readIndices(std::ifstream& file, MeshObject::PrimitiveType type, IndexOutput& indexOutput);
+
+	/// <summary>
+	/// Read an indexed triangle list. Index count is 4 bytes, each index is 2 bytes.
+	/// </summary>
+	/// <param name="file">- source file to read from</param>
+	/// <param name="mesh">- destination mesh to write to</param>
+	static void readTriangleList(std::ifstream& file, MeshObject* mesh);
+	static bool readTriangleList(std::ifstream& file, IndexOutput& indexOutput);
+
+	/// <summary>
+	/// <para/>Read triangle strips one at a time into a single scratch buffer, and expand or concatenate them into the caller's index buffer.
+	/// <para/>No per strip vectors are created.
+	/// </summary>
+	/// <param name="file">- source file to read from</param>
+	/// <param name="indexOutput">- destination index buffer and output mode</param>
+	/// <returns>True if every index fit in the destination buffer</returns>
+	static bool readTriangleStrips(std::ifstream& file, IndexOutput& indexOutput);
+
+	/// <summary>
+	/// Read a single stitched strip. Index count is 4 bytes, each index is 2 bytes. There is no strip count or strip length table.
+	/// </summary>
+	/// <param name="file">- source file to read from</param>
+	/// <param name="mesh">- destination mesh to write to</param>
+	static void readStitchedStrip(std::ifstream& file, MeshObject* mesh);
+
+	/// <summary>
+	/// <para/>Read a single stitched strip into the caller's index buffer.
+	/// <para/>Restart output copies the strip, translating restart indices to indexOutput.restartIndex.
+	/// Triangle list output leaves out the degenerate triangles that join the original strips.
+	/// </summary>
+	/// <param name="file">- source file to read from</param>
+	/// <param name="indexOutput">- destination index buffer and output mode</param>
+	/// <param name="restart">- true if the strip is joined with restart indices, false for degenerate triangles</param>
+	/// <returns>True if every index fit in the destination buffer</returns>
+	static bool readStitchedStrip(std::ifstream& file, IndexOutput& indexOutput, bool restart);
+
 	/// <summary>
 	/// Read UV coords in chunks to reduce overhead from file::read. Maximum chunk size seems to be 256;
 	/// Remaing uvs are read 1 by 1 at the end.
 	/// Each uv is 2 bytes.
+	/// When the uv index count is 0, vertices were split and there is one uv coord per vertex.
 	/// </summary>
 	/// <param name="file">- source file to read from</param>
 	/// <param name="mesh">- destination mesh to write to</param>
@@ -59,6 +156,13 @@ private:
 	/// <param name="mesh">- destination mesh to write to</param>
 	static void readVertexNormals(std::ifstream& file, MeshObject* mesh);
 
+	/// <summary>
+	/// Write fileMagic
+	/// </summary>
+	/// <param name="mesh">- source mesh, whose sizeondisk is updated</param>
+	/// <param name="file">- destination file to write to</param>
+	static void writeHeader(MeshObject* mesh, std::ofstream& file);
+
 	/// <summary>
 	/// Each vertex is represented as 3 floats of 4 bytes each, for the x, y, and z, so 12 bytes per vertex.
 	/// The vertex bytes are stored directly next to each other, with a vertex count at the start.
@@ -79,8 +183,32 @@ private:
 	/// <param name="file">- destination file to write to</param>
 	static void writeTriangleStrips(MeshObject* mesh, std::ofstream& file);
 
+	/// <summary>
+	/// <para/>Write the primitive type as 1 byte, followed by the triangle strips or the triangle list.
+	/// <para/>0 means triangle strips, 1 means triangle list, 2 means one strip stitched with degenerate triangles,
+	/// 3 means one strip stitched with restart indices.
+	/// </summary>
+	/// <param name="mesh">- source mesh to read from</param>
+	/// <param name="file">- destination file to write to</param>
+	static void writeIndices(MeshObject* mesh, std::ofstream& file);
+
+	/// <summary>
+	/// Write indexed triangle list. 4 byte index count, followed by 2 bytes per index.
+	/// </summary>
+	/// <param name="mesh">- source mesh to read from</param>
+	/// <param name="file">- destination file to write to</param>
+	static void writeTriangleList(MeshObject* mesh, std::ofstream& file);
+
+	/// <summary>
+	/// Write a single stitched strip. 4 byte index count, followed by 2 bytes per index.
+	/// </summary>
+	/// <param name="mesh">- source mesh to read from</param>
+	/// <param name="file">- destination file to write to</param>
+	static void writeStitchedStrip(MeshObject* mesh, std::ofstream& file);
+
 	/// <summary>
 	/// Write UV coord strips
+	/// Split meshes have no uv indexes, and are written with a uv index count of 0.
 	/// </summary>
 	/// <param name="mesh">- source mesh to read from</param>
 	/// <param name="file">- destination file to write to</param>
@@ -0,0 +1,183 @@
+#include <cstring>
+#include <utility>
+#include <immintrin.h>
+#include <model/StripExpander.h>
+#include <util/CpuFeatures.hpp>
+
+// Word shuffles for 4 triangles of a strip starting on an even triangle:
+// (0,1,2) (2,1,3) (2,3,4) (4,3,5). The first 8 indices go in one register, the last 4 in another.
+#define WORD(w) (char)(2 * (w)), (char)(2 * (w) + 1)
+
+CPU_TARGET("sse4.1")
+int StripExpander::expandStripSSE(const uint16_t* strip, int length, uint16_t* outIndices)
+{
+	const __m128i lowShuffle = _mm_setr_epi8(WORD(0), WORD(1), WORD(2), WORD(2), WORD(1), WORD(3), WORD(2), WORD(3));
+	const __m128i highShuffle = _mm_setr_epi8(WORD(4), WORD(4), WORD(3), WORD(5), -1, -1, -1, -1, -1, -1, -1, -1);
+	int triangle = 0;
+	// 8 indices are loaded per iteration, but only 6 are used
+	for (; triangle + 8 <= length; triangle += 4) {
+		__m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(strip + triangle));
+		__m128i low = _mm_shuffle_epi8(indices, lowShuffle);
+		__m128i high = _mm_shuffle_epi8(indices, highShuffle);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(outIndices), low);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(outIndices + 8), high);
+		outIndices += 12;
+	}
+	return triangle;
+}
+
+CPU_TARGET("sse4.1")
+int StripExpander::expandStripSSE(const uint16_t* strip, int length, uint32_t* outIndices)
+{
+	const __m128i lowShuffle = _mm_setr_epi8(WORD(0), WORD(1), WORD(2), WORD(2), WORD(1), WORD(3), WORD(2), WORD(3));
+	const __m128i highShuffle = _mm_setr_epi8(WORD(4), WORD(4), WORD(3), WORD(5), -1, -1, -1, -1, -1, -1, -1, -1);
+	int triangle = 0;
+	for (; triangle + 8 <= length; triangle += 4) {
+		__m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(strip + triangle));
+		__m128i low = _mm_shuffle_epi8(indices, lowShuffle);
+		__m128i high = _mm_shuffle_epi8(indices, highShuffle);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(outIndices), _mm_cvtepu16_epi32(low));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(outIndices + 4), _mm_cvtepu16_epi32(_mm_srli_si128(low, 8)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(outIndices + 8), _mm_cvtepu16_epi32(high));
+		outIndices += 12;
+	}
+	return triangle;
+}
+
+#undef WORD
+
+size_t StripExpander::countTriangleListIndices(const std::vector<std::vector<uint16_t>>& strips)
+{
+	size_t numIndices = 0;
+	for (const std::vector<uint16_t>& strip : strips) {
+		if (strip.size() >= 3) numIndices += (strip.size() - 2) * 3;
+	}
+	return numIndices;
+}
+
+size_t StripExpander::countRestartStripIndices(const std::vector<std::vector<uint16_t>>& strips)
+{
+	if (strips.empty()) return 0;
+	size_t numIndices = strips.size() - 1; // one restart index between each strip
+	for (const std::vector<uint16_t>& strip : strips) {
+		numIndices += strip.size();
+	}
+	return numIndices;
+}
+
+template <typename IndexType>
+static size_t expandStripScalar(const uint16_t* strip, int length, int firstTriangle, IndexType* outIndices)
+{
+	IndexType* out = outIndices;
+	for (int i = firstTriangle; i < length - 2; i++) {
+		// odd triangles are wound the other way, swap the first two indices to fix it
+		int odd = i & 1;
+		out[0] = strip[i + odd];
+		out[1] = strip[i + 1 - odd];
+		out[2] = strip[i + 2];
+		out += 3;
+	}
+	return out - outIndices;
+}
+
+template <typename IndexType>
+static size_t expandStitchedStripScalar(const uint16_t* strip, size_t length, bool restart, uint16_t restartIndex, IndexType* outIndices)
+{
+	size_t numIndices = 0;
+	size_t segmentStart = 0;
+	while (segmentStart < length) {
+		size_t segmentEnd = length;
+		if (restart) {
+			segmentEnd = segmentStart;
+			while (segmentEnd < length && strip[segmentEnd] != restartIndex) segmentEnd++;
+		}
+		for (size_t i = segmentStart; i + 2 < segmentEnd; i++) {
+			uint16_t a = strip[i];
+			uint16_t b = strip[i + 1];
+			uint16_t c = strip[i + 2];
+			if (a == b || b == c || a == c) continue;
+			// winding alternates from the start of each segment
+			if ((i - segmentStart) & 1) std::swap(a, b);
+			if (outIndices) {
+				outIndices[numIndices + 0] = a;
+				outIndices[numIndices + 1] = b;
+				outIndices[numIndices + 2] = c;
+			}
+			numIndices += 3;
+		}
+		segmentStart = segmentEnd + 1;
+	}
+	return numIndices;
+}
+
+size_t StripExpander::countStitchedTriangleListIndices(const uint16_t* strip, size_t length, bool restart, uint16_t restartIndex)
+{
+	return expandStitchedStripScalar(strip, length, restart, restartIndex, (uint16_t*)nullptr);
+}
+
+size_t StripExpander::expandStitchedStrip(const uint16_t* strip, size_t length, bool restart, uint16_t* outIndices, uint16_t restartIndex)
+{
+	return expandStitchedStripScalar(strip, length, restart, restartIndex, outIndices);
+}
+
+size_t StripExpander::expandStitchedStrip(const uint16_t* strip, size_t length, bool restart, uint32_t* outIndices, uint16_t restartIndex)
+{
+	return expandStitchedStripScalar(strip, length, restart, restartIndex, outIndices);
+}
+
+size_t StripExpander::expandStrip(const uint16_t* strip, int length, uint16_t* outIndices)
+{
+	if (length < 3) return 0;
+	int firstTriangle = CpuFeatures::hasSSE41() ? expandStripSSE(strip, length, outIndices) : 0;
+	return firstTriangle * 3 + expandStripScalar(strip, length, firstTriangle, outIndices + firstTriangle * 3);
+}
+
+size_t StripExpander::expandStrip(const uint16_t* strip, int length, uint32_t* outIndices)
+{
+	if (length < 3) return 0;
+	int firstTriangle = CpuFeatures::hasSSE41() ? expandStripSSE(strip, length, outIndices) : 0;
+	return firstTriangle * 3 + expandStripScalar(strip, length, firstTriangle, outIndices + firstTriangle * 3);
+}
+
+size_t StripExpander::expandStrips(const std::vector<std::vector<uint16_t>>& strips, uint16_t* outIndices)
+{
+	size_t numIndices = 0;
+	for (const std::vector<uint16_t>& strip : strips) {
+		numIndices += expandStrip(strip.data(), (int)strip.size(), outIndices + numIndices);
+	}
+	return numIndices;
+}
+
+size_t StripExpander::expandStrips(const std::vector<std::vector<uint16_t>>& strips, uint32_t* outIndices)
+{
+	size_t numIndices = 0;
+	for (const std::vector<uint16_t>& strip : strips) {
+		numIndices += expandStrip(strip.data(), (int)strip.size(), outIndices + numIndices);
+	}
+	return numIndices;
+}
+
+size_t StripExpander::concatenateStrips(const std::vector<std::vector<uint16_t>>& strips, uint16_t* outIndices, uint16_t restartIndex)
+{
+	uint16_t* out = outIndices;
+	for (size_t i = 0; i < strips.size(); i++) {
+		if (i > 0) *out++ = restartIndex;
+		memcpy(out, strips[i].data(), strips[i].size() * sizeof(uint16_t));
+		out += strips[i].size();
+	}
+	return out - outIndices;
+}
+
+size_t StripExpander::concatenateStrips(const std::vector<std::vector<uint16_t>>& strips, uint32_t* outIndices, uint32_t restartIndex)
+{
+	uint32_t* out = outIndices;
+	for (size_t i = 0; i < strips.size(); i++) {
+		if (i > 0) *out++ = restartIndex;
+		const uint16_t* strip = strips[i].data();
+		for (size_t j = 0; j < strips[i].size(); j++) {
+			out[j] = strip[j];
+		}
+		out += strips[i].size();
+	}
+	return out - outIndices;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef SRC_MODEL_STRIPEXPANDER_H_
+#define SRC_MODEL_STRIPEXPANDER_H_
+
+#include <vector>
+#include <cstdint>
+
+class StripExpander {
+private:
+	/// <summary>
+	/// <para/>Expand 4 triangles per iteration using SSE4.1 shuffles. Returns the number of triangles that were expanded,
+	/// the caller expands the rest with the scalar loop.
+	/// </summary>
+	static int expandStripSSE(const uint16_t* strip, int length, uint16_t* outIndices);
+	static int expandStripSSE(const uint16_t* strip, int length, uint32_t* outIndices);
+public:
+	/// <summary>
+	/// Number of indices needed to store the strips as a triangle list. 3 indices per triangle.
+	/// </summary>
+	/// <param name="strips">- source strips</param>
+	/// <returns>Index count</returns>
+	static size_t countTriangleListIndices(const std::vector<std::vector<uint16_t>>& strips);
+
+	/// <summary>
+	/// Number of indices needed to store the strips as one strip, with a restart index between each strip.
+	/// </summary>
+	/// <param name="strips">- source strips</param>
+	/// <returns>Index count</returns>
+	static size_t countRestartStripIndices(const std::vector<std::vector<uint16_t>>& strips);
+
+	/// <summary>
+	/// <para/>Number of indices needed to store a stitched strip as a triangle list, leaving out the degenerate triangles.
+	/// <para/>With restart set, restartIndex splits the strip into separate strips.
+	/// </summary>
+	/// <param name="strip">- strip indices</param>
+	/// <param name="length">- number of indices in the strip</param>
+	/// <param name="restart">- true if the strip contains restart indices</param>
+	/// <param name="restartIndex">- index value that restarts the strip</param>
+	/// <returns>Index count</returns>
+	static size_t countStitchedTriangleListIndices(const uint16_t* strip, size_t length, bool restart, uint16_t restartIndex = 0xFFFF);
+
+	/// <summary>
+	/// <para/>Expand a strip made by StripStitcher into a triangle list, leaving out the degenerate triangles that join the original strips.
+	/// <para/>outIndices must have room for countStitchedTriangleListIndices indices.
+	/// </summary>
+	/// <param name="strip">- strip indices</param>
+	/// <param name="length">- number of indices in the strip</param>
+	/// <param name="restart">- true if the strip contains restart indices</param>
+	/// <param name="outIndices">- destination buffer</param>
+	/// <param name="restartIndex">- index value that restarts the strip</param>
+	/// <returns>Number of indices written</returns>
+	static size_t expandStitchedStrip(const uint16_t* strip, size_t length, bool restart, uint16_t* outIndices, uint16_t restartIndex = 0xFFFF);
+	static size_t expandStitchedStrip(const uint16_t* strip, size_t length, bool restart, uint32_t* outIndices, uint16_t restartIndex = 0xFFFF);
+
+	/// <summary>
+	/// <para/>Expand a single triangle strip into a triangle list, written directly into outIndices.
+	/// <para/>Odd triangles have their first two indices swapped, so every triangle keeps the winding of the first one.
+	/// <para/>outIndices must have room for (length - 2) * 3 indices.
+	/// </summary>
+	/// <param name="strip">- strip indices</param>
+	/// <param name="length">- number of indices in the strip</param>
+	/// <param name="outIndices">- destination buffer</param>
+	/// <returns>Number of indices written</returns>
+	static size_t expandStrip(const uint16_t* strip, int length, uint16_t* outIndices);
+	static size_t expandStrip(const uint16_t* strip, int length, uint32_t* outIndices);
+
+	/// <summary>
+	/// Expand every strip into one triangle list. outIndices must have room for countTriangleListIndices(strips) indices.
+	/// </summary>
+	/// <param name="strips">- source strips</param>
+	/// <param name="outIndices">- destination buffer</param>
+	/// <returns>Number of indices written</returns>
+	static size_t expandStrips(const std::vector<std::vector<uint16_t>>& strips, uint16_t* outIndices);
+	static size_t expandStrips(const std::vector<std::vector<uint16_t>>& strips, uint32_t* outIndices);
+
+	/// <summary>
+	/// <para/>Concatenate every strip into one strip, separated by restartIndex, for drawing with primitive restart enabled.
+	/// <para/>outIndices must have room for countRestartStripIndices(strips) indices.
+	/// </summary>
+	/// <param name="strips">- source strips</param>
+	/// <param name="outIndices">- destination buffer</param>
+	/// <param name="restartIndex">- index value that restarts the strip, usually the maximum value of the index type</param>
+	/// <returns>Number of indices written</returns>
+	static size_t concatenateStrips(const std::vector<std::vector<uint16_t>>& strips, uint16_t* outIndices, uint16_t restartIndex = 0xFFFF);
+	static size_t concatenateStrips(const std::vector<std::vector<uint16_t>>& strips, uint32_t* outIndices, uint32_t restartIndex = 0xFFFFFFFF);
+};
+
+#endif
\ No newline at end of file
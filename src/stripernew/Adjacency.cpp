@@ -1,5 +1,8 @@
 #include "Stdafx.h"
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <util/Parallel.hpp>
 
 Adjacencies::~Adjacencies()
 {
@@ -12,6 +15,7 @@ bool Adjacencies::init(AdjacenciesCreate& create)
 	//auto start = Timer::begin();
 	// Allocate ram for triangles and edges. Might fail, so use null checks.
 	faceCount = create.faceCount;
+	threadCount = create.threadCount;
 	faces = new AdjTriangle[faceCount];
 	if(!faces) return false;
 	edges = new AdjEdge[faceCount * 3];
@@ -66,49 +70,98 @@ bool Adjacencies::addEdge(uint32_t vertex0, uint32_t vertex1, uint32_t faceIndex
 bool Adjacencies::createDatabase()
 {
 	// Here edgeCount should be equal to currentFaceIndex*3.
+	bool status;
+	if(threadCount > 1 && edgeCount >= parallelEdgeCount) status = createDatabaseParallel();
+	else status = linkEdges(null, edgeCount);
+
+	// We don't need the edges anymore
+	if(status) RELEASEARRAY(edges);
+
+	return status;
+}
+
+/// <summary>
+/// Bucket the edges by the range their first (smaller) vertex falls in, one partition per thread, and link each partition on its own thread.
+/// Both copies of a shared edge are in the same partition, so no two threads write the same link.
+/// </summary>
+/// <returns>False if an edge is shared by more than 2 triangles</returns>
+bool Adjacencies::createDatabaseParallel()
+{
+	uint32_t vertexRange = 1;
+	for(uint32_t i = 0; i < edgeCount; i++) vertexRange = std::max(vertexRange, edges[i].vertex0 + 1);
+	uint32_t partitionCount = threadCount;
+	std::vector<uint32_t> offsets(partitionCount + 1, 0);
+	for(uint32_t i = 0; i < edgeCount; i++) offsets[(uint64_t)edges[i].vertex0 * partitionCount / vertexRange + 1]++;
+	for(uint32_t p = 0; p < partitionCount; p++) offsets[p + 1] += offsets[p];
+	std::vector<uint32_t> partitionEdges(edgeCount);
+	{
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for(uint32_t i = 0; i < edgeCount; i++) partitionEdges[fill[(uint64_t)edges[i].vertex0 * partitionCount / vertexRange]++] = i;
+	}
+
+	std::vector<uint8_t> results(partitionCount, 1);
+	Parallel::forRange(partitionCount, threadCount, [&](size_t begin, size_t end, int) {
+		for(size_t p = begin; p < end; p++) results[p] = linkEdges(&partitionEdges[offsets[p]], offsets[p + 1] - offsets[p]);
+	});
+	for(uint8_t result : results) {
+		if(!result) return false;
+	}
+	return true;
+}
+
+/// <summary>
+/// Sort edges by face, first vertex and second vertex, and link the faces that share an edge.
+/// </summary>
+/// <param name="edgeList">- indices of the edges to link, or null for the first count edges</param>
+/// <param name="count">- number of edges</param>
+/// <returns>False if an edge is shared by more than 2 triangles</returns>
+bool Adjacencies::linkEdges(const uint32_t* edgeList, uint32_t count)
+{
+	if(count == 0) return true;
 
 	RadixSorter Core;
 
-	uint32_t* faceIndices = new uint32_t[edgeCount]; if(!faceIndices) return false;
-	uint32_t* firstVertexIndices = new uint32_t[edgeCount]; if(!firstVertexIndices) return false;
-	uint32_t* secondVertexIndices = new uint32_t[edgeCount]; if(!secondVertexIndices) return false;
+	uint32_t* faceIndices = new uint32_t[count]; if(!faceIndices) return false;
+	uint32_t* firstVertexIndices = new uint32_t[count]; if(!firstVertexIndices) return false;
+	uint32_t* secondVertexIndices = new uint32_t[count]; if(!secondVertexIndices) return false;
 
-	for(uint32_t i = 0; i < edgeCount; i++) {
-		faceIndices[i] = edges[i].faceIndex;
-		firstVertexIndices[i] = edges[i].vertex0;
-		secondVertexIndices[i] = edges[i].vertex1;
+	for(uint32_t i = 0; i < count; i++) {
+		const AdjEdge& edge = edges[edgeList ? edgeList[i] : i];
+		faceIndices[i] = edge.faceIndex;
+		firstVertexIndices[i] = edge.vertex0;
+		secondVertexIndices[i] = edge.vertex1;
 	}
 
 	// Multiple sort
 	uint32_t* sorted = Core
-		.sort(faceIndices, edgeCount)
-		.sort(firstVertexIndices, edgeCount)
-		.sort(secondVertexIndices, edgeCount)
+		.sort(faceIndices, count)
+		.sort(firstVertexIndices, count)
+		.sort(secondVertexIndices, count)
 		.getIndices();
 
 	// Read the list in sorted order, look for similar edges
 	uint32_t lastVertex0 = firstVertexIndices[sorted[0]];
 	uint32_t lastVertex1 = secondVertexIndices[sorted[0]];
-	uint32_t count = 0;
+	uint32_t sharedCount = 0;
 	uint32_t tmpBuffer[3];
 
-	for(int i = 0; i < edgeCount; i++) {
+	for(uint32_t i = 0; i < count; i++) {
 		uint32_t face = faceIndices[sorted[i]]; // Owner face
 		uint32_t vertex0 = firstVertexIndices[sorted[i]]; // Vertex ref #1
 		uint32_t vertex1 = secondVertexIndices[sorted[i]]; // Vertex ref #2
 		if(vertex0 == lastVertex0 && vertex1 == lastVertex1) {
 			// Current edge is the same as last one
-			tmpBuffer[count++] = face; // Store face number
-			if(count == 3) {
+			tmpBuffer[sharedCount++] = face; // Store face number
+			if(sharedCount == 3) {
 				RELEASEARRAY(secondVertexIndices);
 				RELEASEARRAY(firstVertexIndices);
 				RELEASEARRAY(faceIndices);
 				return false; // Only works with manifold meshes (i.e. an edge is not shared by more than 2 triangles)
 			}
 		} else {
-			// Here we have a new edge (lastVertex0, lastVertex1) shared by count triangles stored in tmpBuffer
-			if(count == 2) {
-				// if count == 1 => edge is a boundary edge: it belongs to a single triangle.
+			// Here we have a new edge (lastVertex0, lastVertex1) shared by sharedCount triangles stored in tmpBuffer
+			if(sharedCount == 2) {
+				// if sharedCount == 1 => edge is a boundary edge: it belongs to a single triangle.
 				// Hence there's no need to update a link to an adjacent triangle.
 				bool status = updateLink(tmpBuffer[0], tmpBuffer[1], lastVertex0, lastVertex1);
 				if(!status)
@@ -120,22 +173,19 @@ bool Adjacencies::createDatabase()
 				}
 			}
 			// Reset for next edge
-			count = 0;
-			tmpBuffer[count++] = face;
+			sharedCount = 0;
+			tmpBuffer[sharedCount++] = face;
 			lastVertex0 = vertex0;
 			lastVertex1 = vertex1;
 		}
 	}
 	bool status = true;
-	if(count == 2) status = updateLink(tmpBuffer[0], tmpBuffer[1], lastVertex0, lastVertex1);
+	if(sharedCount == 2) status = updateLink(tmpBuffer[0], tmpBuffer[1], lastVertex0, lastVertex1);
 
 	RELEASEARRAY(secondVertexIndices);
 	RELEASEARRAY(firstVertexIndices);
 	RELEASEARRAY(faceIndices);
 
-	// We don't need the edges anymore
-	RELEASEARRAY(edges);
-
 	return status;
 }
 
@@ -185,4 +235,4 @@ uint32_t AdjTriangle::oppositeVertex(uint32_t vertex0, uint32_t vertex1)
 	else if(vertexIndices[1]==vertex0 && vertexIndices[2]==vertex1) vertexIndex = vertexIndices[0];
 	else if(vertexIndices[1]==vertex1 && vertexIndices[2]==vertex0) vertexIndex = vertexIndices[0];
 	return vertexIndex;
-}
+}
\ No newline at end of file
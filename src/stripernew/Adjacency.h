@@ -24,8 +24,10 @@ struct AdjacenciesCreate {
 		DFaces = NULL;
 		WFaces = NULL;
 		faceCount = 0;
+		threadCount = 1;
 	}
 	uint32_t faceCount; // #faces in source topo
+	uint32_t threadCount; // threads used by createDatabase
 	uint32_t* DFaces; // list of faces (dwords) or null
 	uint16_t* WFaces; // list of faces (words) or null
 };
@@ -34,20 +36,26 @@ class Adjacencies {
 private:
 	uint32_t edgeCount;
 	uint32_t currentFaceIndex;
+	uint32_t threadCount;
 	AdjEdge* edges;
 
 	bool addTriangle(uint32_t vertex0, uint32_t vertex1, uint32_t vertex3);
 	bool addEdge(uint32_t vertex0, uint32_t vertex1, uint32_t faceIndex);
 	bool updateLink(uint32_t firstTri, uint32_t secondTri, uint32_t vertex0, uint32_t vertex1);
 	uint8_t findEdge(AdjTriangle* tri, uint32_t vertex0, uint32_t vertex1);
+	bool linkEdges(const uint32_t* edgeList, uint32_t count);
+	bool createDatabaseParallel();
 
 public:
-	Adjacencies() : edgeCount(0), currentFaceIndex(0), edges(NULL), faceCount(0), faces(NULL) {}
+	Adjacencies() : edgeCount(0), currentFaceIndex(0), threadCount(1), edges(NULL), faceCount(0), faces(NULL) {}
 	~Adjacencies();
 
 	uint32_t faceCount;
 	AdjTriangle* faces;
 
+	// Meshes with fewer edges than this are always linked on one thread
+	static const uint32_t parallelEdgeCount = 150000;
+
 	bool init(AdjacenciesCreate& create);
 	bool createDatabase();
 };
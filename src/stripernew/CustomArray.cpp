@@ -78,7 +78,7 @@ CustomArray& CustomArray::NewBlock(CustomCell* previouscell, unsigned long size)
 	Cell->Item.Max = previouscell ? previouscell->Item.Max*2 : size;
 
 	// Get some bytes for this cell
-	Cell->Item.Addy = (void*)new uint8_t[Cell->Item.Max];
+	Cell->Item.Addy = new uint8_t[Cell->Item.Max];
 	Cell->Item.Size = 0;
 
 	mCurrentCell = Cell;
@@ -169,7 +169,7 @@ class CustomArray {
 	struct CustomBlock {
 		CustomBlock() { Addy = null; }
 		~CustomBlock() { RELEASEARRAY(Addy); }
-		void* Addy; // Stored data
+		uint8_t* Addy; // Stored data
 		unsigned long Size; // Length of stored data
 		unsigned long Max; // Heap size
 	};
@@ -185,7 +185,7 @@ private:
 	CustomCell* mCurrentCell; // Current block cell
 	CustomCell* mInitCell; 	// First block cell
 
-	void* mCollapsed; // Possible collapsed buffer
+	uint8_t* mCollapsed; // Possible collapsed buffer
 	void** mAddresses; // Stack to store addresses
 	void* mLastAddress; // Last address used in current block cell
 	unsigned short mNbPushedAddies; // #saved addies
@@ -1,5 +1,7 @@
 #include "Stdafx.h"
 #include <iostream>
+#include <algorithm>
+#include <util/Parallel.hpp>
 
 Striper& Striper::freeUsedRam()
 {
@@ -7,12 +9,13 @@ Striper& Striper::freeUsedRam()
 	RELEASE(stripIndices);
 	RELEASE(stripLengths);
 	RELEASEARRAY(tags);
+	releaseCandidates();
 	RELEASE(adacencies);
 	return *this;
 }
 
-Striper::Striper() {
-	freeUsedRam();
+Striper::Striper() : adacencies(null), tags(null), visited(null), visitedCount(0), stripCount(0), stripLengths(null), stripIndices(null),
+	singleStripLength(0), singleStrip(null), askforUINT16(true), oneSided(true), SGIAlgorithm(true), shouldConnectAllStrips(false), threadCount(1), speculativeStarts(0) {
 }
 
 Striper::~Striper() {
@@ -24,6 +27,8 @@ void Striper::setOptions(StriperOptions& options) {
 	oneSided = options.oneSided;
 	SGIAlgorithm = options.SGIAlgorithm;
 	shouldConnectAllStrips = options.connectAllStrips;
+	threadCount = std::max(1u, options.threadCount);
+	speculativeStarts = options.speculativeStarts;
 }
 
 /// <summary>
@@ -41,6 +46,7 @@ bool Striper::init(StriperOptions& options) {
 	ac.faceCount = options.faceCount;
 	ac.DFaces = options.DFaces;
 	ac.WFaces = options.WFaces;
+	ac.threadCount = options.threadCount;
 	bool status = adacencies->init(ac);
 	if (!status) { RELEASE(adacencies); return false; }
 	status = adacencies->createDatabase();
@@ -69,28 +75,25 @@ bool Striper::compute(StriperResult& result)
 	if(!tags) return false;
 	uint32_t* connectivity	= new uint32_t[adacencies->faceCount];
 	if(!connectivity) return false;
+	// Scratch for the candidate strips, reused by every strip
+	if(!allocateCandidates(speculativeStarts ? speculativeStarts : 1)) return false;
 
 	// tags contains one bool/face. True=>the face has already been included in a strip
 	ZeroMemory(tags, adacencies->faceCount*sizeof(bool));
 
-	// Compute the number of connections for each face. This buffer is further recycled into
-	// the insertion order, ie contains face indices in the order we should treat them
-	ZeroMemory(connectivity, adacencies->faceCount*sizeof(uint32_t));
 	if(SGIAlgorithm) {
-		// Compute number of adjacent triangles for each face
-		for(uint32_t i = 0; i < adacencies->faceCount; i++) {
+		// Queue every face by its number of adjacent triangles. tagFace keeps the counts up to date as strips use faces,
+		// so each strip starts at the face with the fewest untagged neighbours left.
+		// Faces are pushed backwards so that ties come out in index order.
+		faceQueue.reset(adacencies->faceCount, 3);
+		for(uint32_t i = adacencies->faceCount; i-- > 0;) {
 			AdjTriangle* tri = &adacencies->faces[i];
-			if(!IS_BOUNDARY(tri->adjacentTris[0])) connectivity[i]++;
-			if(!IS_BOUNDARY(tri->adjacentTris[1])) connectivity[i]++;
-			if(!IS_BOUNDARY(tri->adjacentTris[2])) connectivity[i]++;
+			int neighbours = 0;
+			if(!IS_BOUNDARY(tri->adjacentTris[0])) neighbours++;
+			if(!IS_BOUNDARY(tri->adjacentTris[1])) neighbours++;
+			if(!IS_BOUNDARY(tri->adjacentTris[2])) neighbours++;
+			faceQueue.push(i, neighbours);
 		}
-
-		// Sort by number of neighbors
-		RadixSorter RS;
-		uint32_t* Sorted = RS.sort(connectivity, adacencies->faceCount).getIndices();
-
-		// The sorted indices become the order of insertion in the strips
-		CopyMemory(connectivity, Sorted, adacencies->faceCount*sizeof(uint32_t));
 	} else {
 		// Default order
 		for(uint32_t i = 0; i < adacencies->faceCount; i++) connectivity[i] = i;
@@ -99,14 +102,33 @@ bool Striper::compute(StriperResult& result)
 	stripCount = 0;	// #strips created
 	uint32_t totalFaceCount	= 0; // #faces already transformed into strips
 	uint32_t index = 0;	// Index of first face
+	uint32_t batchSize = 0; // #start faces of the current speculative batch
 
 	while(totalFaceCount!=adacencies->faceCount) {
-		// Look for the first face [could be optimized]
-		while(tags[connectivity[index]]) index++;
-		uint32_t firstFace = connectivity[index];
+		// Look for the first face
+		uint32_t firstFace;
+		if(SGIAlgorithm) {
+			firstFace = (uint32_t)faceQueue.popMin();
+		} else {
+			while(tags[connectivity[index]]) index++;
+			firstFace = connectivity[index];
+		}
 
-		// Compute the three possible strips from this face and take the best
-		totalFaceCount += computeBestStrip(firstFace);
+		if(!speculativeStarts) {
+			// Compute the three possible strips from this face and take the best
+			totalFaceCount += computeBestStrip(firstFace);
+		} else {
+			// Take the strips the current batch tracked from this face if none of their faces got tagged since, else start a new batch here
+			StripCandidates* speculated = null;
+			for(uint32_t i = 0; i < batchSize && !speculated; i++) {
+				if(candidates[i].face == firstFace && isSpeculationValid(candidates[i])) speculated = &candidates[i];
+			}
+			if(!speculated) {
+				batchSize = speculate(firstFace, index, connectivity);
+				speculated = &candidates[0];
+			}
+			totalFaceCount += commitBestStrip(*speculated);
+		}
 
 		// Let's wrap
 		stripCount++;
@@ -115,6 +137,7 @@ bool Striper::compute(StriperResult& result)
 	// Free now useless ram
 	RELEASEARRAY(connectivity);
 	RELEASEARRAY(tags);
+	releaseCandidates();
 
 	// Fill result structure and exit
 	result.stripCount = this->stripCount;
@@ -127,71 +150,117 @@ bool Striper::compute(StriperResult& result)
 }
 
 /// <summary>
-/// Compute the three possible strips starting from a given face
+/// Get room for the strips tried from count start faces, and the per thread marks when strips are tracked speculatively.
+/// The strip buffers start small and grow with the strips, so they only take as much memory as the longest strips tracked.
+/// </summary>
+/// <param name="count">#start faces</param>
+/// <returns>true if success</returns>
+bool Striper::allocateCandidates(uint32_t count)
+{
+	candidates.resize(count);
+	for(uint32_t i = 0; i < count; i++) candidates[i].face = NO_FACE;
+	if(speculativeStarts) {
+		// A batch has 3 strips per start face, more threads would have nothing to track
+		visitedCount = std::min(threadCount, count * 3);
+		visited = new bool*[visitedCount];
+		if(!visited) return false;
+		for(uint32_t t = 0; t < visitedCount; t++) visited[t] = null;
+		for(uint32_t t = 0; t < visitedCount; t++) {
+			visited[t] = new bool[adacencies->faceCount];
+			if(!visited[t]) return false;
+			ZeroMemory(visited[t], adacencies->faceCount*sizeof(bool));
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// Free the candidate strips and the per thread marks
+/// </summary>
+void Striper::releaseCandidates()
+{
+	std::vector<StripCandidates>().swap(candidates);
+	if(visited) {
+		for(uint32_t t = 0; t < visitedCount; t++) RELEASEARRAY(visited[t]);
+	}
+	RELEASEARRAY(visited);
+	visitedCount = 0;
+}
+
+/// <summary>
+/// Compute the three possible strips starting from a given face, and store the best one.
+/// Each strip tags its faces in the global tags while it's tracked, and untags them afterwards, so only the faces a strip visits are touched.
 /// </summary>
 /// <param name="face"></param>
-/// <returns></returns>
+/// <returns>#faces involved in the strip</returns>
 uint32_t Striper::computeBestStrip(uint32_t face)
 {
-	uint32_t* strip[3];		// Strips computed in the 3 possible directions
-	uint32_t* faces[3];		// Faces involved in the 3 previous strips
-	uint32_t length[3];		// Lengths of the 3 previous strips
+	StripCandidates& current = candidates[0];
+	current.face = face;
+	for(int j = 0; j < 3; j++) trackCandidate(current, j, tags, tags);
+	return commitBestStrip(current);
+}
 
-	uint32_t firstLength[3];	// Lengths of the first parts of the strips are saved for culling
+/// <summary>
+/// Track the strip that starts on one edge of the start face, in both directions.
+/// It only reads tags, and marks its faces in visited, which it clears again when it's done, so strips with their own visited
+/// marks can be tracked at the same time. visited may be tags itself when striping one face at a time.
+/// </summary>
+/// <param name="candidates">start face, and the strips to fill in</param>
+/// <param name="direction">edge of the start face the strip starts on, 0 to 2</param>
+/// <param name="tags">faces already in a strip</param>
+/// <param name="visited">faces this strip went through, all false on entry and on return</param>
+void Striper::trackCandidate(StripCandidates& candidates, int direction, const bool* tags, bool* visited)
+{
+	uint32_t face = candidates.face;
+	std::vector<uint32_t>& strip = candidates.strip[direction];
+	std::vector<uint32_t>& faces = candidates.faces[direction];
+	uint32_t& length = candidates.length[direction];
 
 	// Starting references
-	uint32_t firstVertices[3];
-	uint32_t secondVertices[3];
-	firstVertices[0] = adacencies->faces[face].vertexIndices[0];
-	secondVertices[0] = adacencies->faces[face].vertexIndices[1];
-
 	// Bugfix by Eric Malafeew!
-	firstVertices[1] = adacencies->faces[face].vertexIndices[2];
-	secondVertices[1] = adacencies->faces[face].vertexIndices[0];
-
-	firstVertices[2] = adacencies->faces[face].vertexIndices[1];
-	secondVertices[2] = adacencies->faces[face].vertexIndices[2];
+	static const int firstCorners[3] = { 0, 2, 1 };
+	static const int secondCorners[3] = { 1, 0, 2 };
+	uint32_t firstVertex = adacencies->faces[face].vertexIndices[firstCorners[direction]];
+	uint32_t secondVertex = adacencies->faces[face].vertexIndices[secondCorners[direction]];
+
+	// Track first part of the strip
+	length = trackStrip(face, firstVertex, secondVertex, strip, faces, 0, tags, visited);
+
+	// Save first length for culling
+	candidates.firstLength[direction] = length;
+//	if(j==1)	firstLength[j]++;	// ...because the first face is written in reverse order for j==1
+
+	// Reverse first part of the strip
+	for(uint32_t i=0;i<length/2;i++) {
+		strip[i]	^= strip[length - i - 1];
+		strip[length - i - 1] ^= strip[i];
+		strip[i]	^= strip[length - i - 1];
+	}
+	for(int i = 0; i < (length - 2) / 2; i++) {
+		faces[i]^= faces[length - i - 3];
+		faces[length - i - 3]	^= faces[i];
+		faces[i]^= faces[length - i - 3];
+	}
 
-	// Compute 3 strips
-	for(int j = 0; j < 3; j++) {
-		// Get some bytes for the strip and its faces
-		strip[j] = new uint32_t[adacencies->faceCount + 2 + 1 + 2];	// max possible length is faceCount+2, 1 more if the first index gets replicated
-		faces[j] = new uint32_t[adacencies->faceCount + 2];
-		FillMemory(strip[j], (adacencies->faceCount + 2 + 1 + 2) * sizeof(uint32_t), 0xff);
-		FillMemory(faces[j], (adacencies->faceCount + 2) * sizeof(uint32_t), 0xff);
-
-		// Create a local copy of the tags
-		bool* localTags	= new bool[adacencies->faceCount];
-		CopyMemory(localTags, this->tags, adacencies->faceCount * sizeof(bool));
-
-		// Track first part of the strip
-		length[j] = trackStrip(face, firstVertices[j], secondVertices[j], &strip[j][0], &faces[j][0], localTags);
-
-		// Save first length for culling
-		firstLength[j] = length[j];
-//		if(j==1)	firstLength[j]++;	// ...because the first face is written in reverse order for j==1
-
-		// Reverse first part of the strip
-		for(uint32_t i=0;i<length[j]/2;i++) {
-			strip[j][i]	^= strip[j][length[j] - i - 1];
-			strip[j][length[j] - i - 1] ^= strip[j][i];
-			strip[j][i]	^= strip[j][length[j] - i - 1];
-		}
-		for(int i = 0; i < (length[j] - 2) / 2; i++) {
-			faces[j][i]^= faces[j][length[j] - i - 3];
-			faces[j][length[j] - i - 3]	^= faces[j][i];
-			faces[j][i]^= faces[j][length[j] - i - 3];
-		}
+	// Track second part of the strip
+	uint32_t newVertex0 = strip[length - 3];
+	uint32_t newVertex1 = strip[length - 2];
+	uint32_t extraLength = trackStrip(face, newVertex0, newVertex1, strip, faces, length - 3, tags, visited);
+	length += extraLength - 3;
 
-		// Track second part of the strip
-		uint32_t newVertex0 = strip[j][length[j] - 3];
-		uint32_t newVertex1 = strip[j][length[j] - 2];
-		uint32_t extraLength = trackStrip(face, newVertex0, newVertex1, &strip[j][length[j] - 3], &faces[j][length[j] - 3], localTags);
-		length[j] += extraLength - 3;
+	// Clear the marks: the faces of the strip are exactly the faces trackStrip marked
+	for(uint32_t i = 0; i < length - 2; i++) visited[faces[i]] = false;
+}
 
-		// Free temp ram
-		RELEASEARRAY(localTags);
-	}
+/// <summary>
+/// Keep the longest of the three strips tracked from a face: tag its faces, and store it.
+/// </summary>
+/// <param name="candidates">the tracked strips</param>
+/// <returns>#faces involved in the strip</returns>
+uint32_t Striper::commitBestStrip(StripCandidates& candidates)
+{
+	uint32_t* length = candidates.length;
 
 	// Look for the best strip among the three
 	uint32_t longest = length[0];
@@ -200,31 +269,34 @@ uint32_t Striper::computeBestStrip(uint32_t face)
 	if(length[2] > longest)	{ longest = length[2]; best = 2; }
 
 	uint32_t faceCount = longest - 2;
+	std::vector<uint32_t>& strip = candidates.strip[best];
+	std::vector<uint32_t>& faces = candidates.faces[best];
 
 	// Update global tags
-	for(int j = 0; j < longest - 2; j++) tags[faces[best][j]] = true;
+	for(int j = 0; j < longest - 2; j++) tagFace(faces[j]);
 
 	// Flip strip if needed ("if the length of the first part of the strip is odd, the strip must be reversed")
-	if(oneSided && firstLength[best]&1) {
+	if(oneSided && candidates.firstLength[best]&1) {
 		// Here the strip must be flipped. I hardcoded a special case for triangles and quads.
 		if(longest == 3 || longest == 4) {
 			// Flip isolated triangle or quad
-			strip[best][1] ^= strip[best][2];
-			strip[best][2] ^= strip[best][1];
-			strip[best][1] ^= strip[best][2];
+			strip[1] ^= strip[2];
+			strip[2] ^= strip[1];
+			strip[1] ^= strip[2];
 		} else {
 			// "to reverse the strip, write it in reverse order"
 			for(int j = 0; j < longest / 2; j++) {
-				strip[best][j] ^= strip[best][longest - j - 1];
-				strip[best][longest - j - 1] ^= strip[best][j];
-				strip[best][j] ^= strip[best][longest - j - 1];
+				strip[j] ^= strip[longest - j - 1];
+				strip[longest - j - 1] ^= strip[j];
+				strip[j] ^= strip[longest - j - 1];
 			}
 
 			// "If the position of the original face in this new reversed strip is odd, you're done"
-			uint32_t newPos = longest - firstLength[best];
+			uint32_t newPos = longest - candidates.firstLength[best];
 			if(newPos &1) {
 				// "Else replicate the first index"
-				for(int j = 0; j < longest; j++) strip[best][longest - j] = strip[best][longest - j - 1];
+				if(strip.size() <= longest) strip.resize(longest + 1);
+				for(int j = 0; j < longest; j++) strip[longest - j] = strip[longest - j - 1];
 				longest++;
 			}
 		}
@@ -232,44 +304,116 @@ uint32_t Striper::computeBestStrip(uint32_t face)
 
 	// Copy best strip in the strip buffers
 	for(int j = 0; j < longest; j++) {
-		uint32_t vertexIndex = strip[best][j];
+		uint32_t vertexIndex = strip[j];
 		if(askforUINT16) stripIndices->Store((uint16_t)vertexIndex); // Saves word reference
 		else stripIndices->Store(vertexIndex); // Saves dword reference
 	}
 	stripLengths->Store(longest);
 
-	// Free local ram
-	for(int j = 0; j < 3; j++) {
-		RELEASEARRAY(faces[j]);
-		RELEASEARRAY(strip[j]);
-	}
+	// The strips from this face are used up
+	candidates.face = NO_FACE;
 
 	// Returns #faces involved in the strip
 	return faceCount;
 }
 
+/// <summary>
+/// Start a speculative batch: guess the faces the next strips start at, and track the three strips of each on threadCount threads,
+/// against the tags as they are now. A guess is used if it's the face the next strip really starts at and none of the faces of its
+/// strips got tagged in the meantime, since its strips are then the ones computeBestStrip would track, so the result doesn't change.
+/// </summary>
+/// <param name="firstFace">face the next strip starts at</param>
+/// <param name="index">position of firstFace in connectivity, without the SGI algorithm</param>
+/// <param name="connectivity">order faces are started at, without the SGI algorithm</param>
+/// <returns>#start faces in the batch, firstFace first</returns>
+uint32_t Striper::speculate(uint32_t firstFace, uint32_t index, const uint32_t* connectivity)
+{
+	uint32_t count = 0;
+	candidates[count++].face = firstFace;
+	if(SGIAlgorithm) {
+		// firstFace has been popped already, the next faces come out of the queue in this order unless strips change their keys
+		faceQueue.peekMin(queuedFaces, candidates.size() - 1);
+		for(size_t i = 0; i < queuedFaces.size(); i++) candidates[count++].face = (uint32_t)queuedFaces[i];
+	} else {
+		for(uint32_t i = index + 1; i < adacencies->faceCount && count < candidates.size(); i++) {
+			if(!tags[connectivity[i]]) candidates[count++].face = connectivity[i];
+		}
+	}
+
+	// Three strips per face, each thread marks the faces of its strips in its own visited array
+	Parallel::forRange(count * 3, visitedCount, [&](size_t begin, size_t end, int thread) {
+		for(size_t i = begin; i < end; i++) trackCandidate(candidates[i / 3], (int)(i % 3), tags, visited[thread]);
+	});
+	return count;
+}
+
+/// <summary>
+/// Tags only ever get set, and the strips from a face only went through faces that were untagged. If those are all still untagged,
+/// tracking the strips again would take the same steps.
+/// </summary>
+/// <param name="candidates">strips tracked speculatively</param>
+/// <returns>true if the strips can be used</returns>
+bool Striper::isSpeculationValid(const StripCandidates& candidates) const
+{
+	for(int j = 0; j < 3; j++) {
+		for(uint32_t i = 0; i < candidates.length[j] - 2; i++) {
+			if(tags[candidates.faces[j][i]]) return false;
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// Mark a face as included in a strip. With the SGI algorithm, its untagged neighbours lose a connection in the face queue.
+/// </summary>
+/// <param name="face">face to tag</param>
+void Striper::tagFace(uint32_t face)
+{
+	tags[face] = true;
+	if(!SGIAlgorithm) return;
+	if(faceQueue.contains(face)) faceQueue.remove(face);
+	AdjTriangle* tri = &adacencies->faces[face];
+	for(int k = 0; k < 3; k++) {
+		uint32_t link = tri->adjacentTris[k];
+		if(IS_BOUNDARY(link)) continue;
+		uint32_t neighbour = MAKE_ADJ_TRI(link);
+		if(faceQueue.contains(neighbour)) faceQueue.changeKey(neighbour, faceQueue.key(neighbour) - 1);
+	}
+}
+
 /// <summary>
 /// Extend a strip in a given direction starting from a given face
 /// </summary>
 /// <param name="face">starting face</param>
 /// <param name="oldest">first two indices of the strip</param>
 /// <param name="middle">started edge</param>
-/// <param name="strip">buffer to store strip</param>
-/// <param name="faces">buffer to store faces of strip</param>
-/// <param name="tags">buffer to mark visited faces</param>
+/// <param name="strip">buffer to store strip, grown when the strip doesn't fit</param>
+/// <param name="faces">buffer to store faces of strip, kept the same size as strip</param>
+/// <param name="offset">position of the strip in strip and faces</param>
+/// <param name="tags">faces already in a strip</param>
+/// <param name="visited">buffer to mark visited faces, may be tags</param>
 /// <returns>strip length</returns>
-uint32_t Striper::trackStrip(uint32_t face, uint32_t oldest, uint32_t middle, uint32_t* strip, uint32_t* faces, bool* tags)
+uint32_t Striper::trackStrip(uint32_t face, uint32_t oldest, uint32_t middle, std::vector<uint32_t>& strip, std::vector<uint32_t>& faces, uint32_t offset, const bool* tags, bool* visited)
 {
 	uint32_t length = 2; // Initial length is 2 since we have 2 indices in input
-	strip[0] = oldest; // First index of the strip
-	strip[1] = middle; // Second index of the strip
+	if(strip.size() < offset + 3) {
+		strip.resize(std::max<size_t>(64, (offset + 3) * 2));
+		faces.resize(strip.size());
+	}
+	strip[offset] = oldest; // First index of the strip
+	strip[offset + 1] = middle; // Second index of the strip
 
 	bool doTheStrip = true;
 	while(doTheStrip) {
+		// Double the buffers when the strip reaches their end, so they only grow a few times
+		if(offset + length == strip.size()) {
+			strip.resize(strip.size() * 2);
+			faces.resize(strip.size());
+		}
 		uint32_t newest = adacencies->faces[face].oppositeVertex(oldest, middle); // Get the third index of a face given two of them
-		strip[length++] = newest; // Extend the strip,...
-		*faces++ = face; // ...keep track of the face,...
-		tags[face] = true; // ...and mark it as "done".
+		faces[offset + length - 2] = face; // Keep track of the face,...
+		strip[offset + length++] = newest; // ...extend the strip,...
+		visited[face] = true; // ...and mark it as "done".
 
 		uint8_t curEdge = adacencies->faces[face].findEdge(middle, newest); // Get the edge ID...
 		uint32_t link = adacencies->faces[face].adjacentTris[curEdge]; // ...and use it to catch the link to adjacent face.
@@ -277,7 +421,7 @@ uint32_t Striper::trackStrip(uint32_t face, uint32_t oldest, uint32_t middle, ui
 			doTheStrip = false; // If the face is no more connected, we're done...
 		} else {
 			face = MAKE_ADJ_TRI(link); // ...else the link gives us the new face index.
-			if(tags[face])	doTheStrip = false; // Is the new face already done?
+			if(tags[face] || visited[face])	doTheStrip = false; // Is the new face already done?
 		}
 		oldest = middle; // Shift the indices and wrap
 		middle = newest;
@@ -347,4 +491,4 @@ bool Striper::connectAllStrips(StriperResult& result)
 	result.stripLengths	= &singleStripLength;
 
 	return true;
-}
+}
\ No newline at end of file
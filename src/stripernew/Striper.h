@@ -1,6 +1,10 @@
 #ifndef SRC_STRIPERNEW_STRIPER_H_
 #define SRC_STRIPERNEW_STRIPER_H_
 
+#include <util/BucketQueue.hpp>
+
+#define NO_FACE 0xffffffff // start face of candidate strips that aren't tracked from any face
+
 struct StriperOptions {
 	uint32_t faceCount; // #faces in source topo
 	uint32_t* DFaces; // list of faces (dwords) or null
@@ -9,6 +13,8 @@ struct StriperOptions {
 	bool oneSided; // true => create one-sided strips
 	bool SGIAlgorithm; // true => use the SGI algorithm, pick least connected faces first
 	bool connectAllStrips; // true => create a single strip with void faces
+	uint32_t threadCount; // threads used to build the adjacencies, and to track speculative strips
+	uint32_t speculativeStarts; // start faces whose 3 strips are tracked at once on threadCount threads, 0 => one face at a time
 
 	StriperOptions() {
 		DFaces = null;
@@ -18,6 +24,8 @@ struct StriperOptions {
 		oneSided = true;
 		SGIAlgorithm = true;
 		connectAllStrips = false;
+		threadCount = 1;
+		speculativeStarts = 0;
 	}
 };
 
@@ -28,15 +36,38 @@ struct StriperResult {
 	bool askforUINT16; // true => results are in words (else dwords)
 };
 
+/// <summary>
+/// The 3 strips tracked from a start face, one per edge of the face. The longest one is kept.
+/// </summary>
+struct StripCandidates {
+	uint32_t face; // start face
+	std::vector<uint32_t> strip[3]; // indices of each strip, grown as longer strips come along and kept for the next ones
+	std::vector<uint32_t> faces[3]; // faces of each strip, same size as strip
+	uint32_t length[3]; // #indices of each strip
+	uint32_t firstLength[3]; // #indices of the first part of each strip, saved for culling
+};
+
 class Striper {
 private:
 	Striper& freeUsedRam();
+	bool allocateCandidates(uint32_t count);
+	void releaseCandidates();
 	uint32_t computeBestStrip(uint32_t face);
-	uint32_t trackStrip(uint32_t face, uint32_t oldest, uint32_t middle, uint32_t* strip, uint32_t* faces, bool* tags);
+	void trackCandidate(StripCandidates& candidates, int direction, const bool* tags, bool* visited);
+	uint32_t commitBestStrip(StripCandidates& candidates);
+	uint32_t speculate(uint32_t firstFace, uint32_t index, const uint32_t* connectivity);
+	bool isSpeculationValid(const StripCandidates& candidates) const;
+	void tagFace(uint32_t face);
+	uint32_t trackStrip(uint32_t face, uint32_t oldest, uint32_t middle, std::vector<uint32_t>& strip, std::vector<uint32_t>& faces, uint32_t offset, const bool* tags, bool* visited);
 	bool connectAllStrips(StriperResult& result);
 
 	Adjacencies* adacencies; // Adjacency structures
 	bool* tags; // face markers
+	std::vector<StripCandidates> candidates; // strips tried from each start face of a speculative batch, or from the current face
+	bool** visited; // per thread marks of the faces a speculative strip went through, cleared by the strip when it's done
+	uint32_t visitedCount; // #threads with marks, at most 3 per start face of a batch
+	BucketQueue faceQueue; // untagged faces keyed by their number of untagged neighbours, for the SGI algorithm
+	std::vector<int> queuedFaces; // faces the SGI algorithm should start strips at next, for speculation
 
 	uint32_t stripCount; // The number of strips created for the mesh
 	CustomArray* stripLengths; // Array to store strip lengths
@@ -50,6 +81,8 @@ private:
 	bool oneSided;
 	bool SGIAlgorithm;
 	bool shouldConnectAllStrips;
+	uint32_t threadCount;
+	uint32_t speculativeStarts;
 
 public:
 	Striper();
@@ -60,4 +93,4 @@ public:
 	bool compute(StriperResult& result);
 };
 
-#endif
+#endif
\ No newline at end of file
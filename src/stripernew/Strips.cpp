@@ -1,43 +1,62 @@
 #include "Stdafx.h"
 #include <iostream>
-#include <fbxsdk.h>
-#include <model/MeshObject.h>
+#include <string>
+#include <algorithm>
+#include <stripernew/Strips.h>
+#include <util/Timer.hpp>
 
-void striper3(FbxMesh* inMesh, MeshObject* outMesh)
+void StriperBackend::setOptions(const StripOptions& options)
 {
-	int* vertices = inMesh->GetPolygonVertices();
-	std::vector<uint32_t> faces(inMesh->GetPolygonCount() * 3);
-	uint32_t* ptr = faces.data();
-	for (int i = 0; i < faces.size(); i++) {
-		ptr[i] = vertices[i];
-	}
+	this->options = options;
+}
+
+bool StriperBackend::striper(MeshObject* mesh)
+{
+	auto start = Timer::begin();
 	StriperOptions sc;
-	sc.DFaces = ptr;
-	sc.faceCount = inMesh->GetPolygonCount();
+	sc.DFaces = mesh->triangleList.data();
+	sc.faceCount = (uint32_t)(mesh->triangleList.size() / 3);
 	sc.askforUINT16 = true;
 	sc.connectAllStrips = false;
-	sc.oneSided = false;
-	sc.SGIAlgorithm = true;
-
-	Striper Strip;
-	Strip.init(sc);
+	sc.oneSided = options.oneSided;
+	sc.SGIAlgorithm = options.leastConnectedFirst;
+	sc.threadCount = (uint32_t)std::max(1, options.threadCount);
+	sc.speculativeStarts = (uint32_t)std::max(0, std::min(options.speculativeStarts, (int)StripOptions::maxSpeculativeStarts));
 
+	Striper strip;
+	if (!strip.init(sc)) {
+		std::cout << "Striper couldn't build adjacencies, the mesh is probably non-manifold" << std::endl;
+		return false;
+	}
 	StriperResult sr;
-	Strip.compute(sr);
+	if (!strip.compute(sr)) return false;
 
-	std::cout << "Number of strips: " << sr.stripCount << std::endl;
-	//int numTris = 0;
-	//for(uint32_t i = 0; i < sr.stripCount; i++)
-	//{
-	//	uint32_t stripLength = sr.stripLengths[i];
-	//	numTris += stripLength - 2;
-	//	std::cout << stripLength << "\n";
-	//}
-	//std::cout << "Num Tris: " << numTris << std::endl;
-	uint16_t* indices = (uint16_t*)sr.stripIndices;
-	for (int i = 0; i < sr.stripLengths[0]; i++) {
-		std::cout << *indices << " ";
-		indices++;
+	// The result lives in the striper's arrays, so copy it out before it goes out of scope
+	std::vector<std::vector<uint16_t>>& strips = mesh->triangleStrips;
+	strips.clear();
+	strips.resize(sr.stripCount);
+	const uint16_t* indices = (const uint16_t*)sr.stripIndices;
+	for (uint32_t i = 0; i < sr.stripCount; i++) {
+		strips[i].assign(indices, indices + sr.stripLengths[i]);
+		indices += sr.stripLengths[i];
 	}
-	std::cout << std::endl;
+	mesh->primitiveType = MeshObject::PrimitiveType::TriangleStrips;
+	mesh->triangleList.clear();
+	Timer::end(start, "Found (" + std::to_string(sr.stripCount) + ") triangle strips: ");
+	return true;
 }
+
+bool StriperBackend::linkFaces(const std::vector<uint32_t>& triangleList, int threadCount, std::vector<uint32_t>& links)
+{
+	AdjacenciesCreate create;
+	create.DFaces = const_cast<uint32_t*>(triangleList.data());
+	create.faceCount = (uint32_t)(triangleList.size() / 3);
+	create.threadCount = (uint32_t)std::max(1, threadCount);
+	Adjacencies adjacencies;
+	if (!adjacencies.init(create) || !adjacencies.createDatabase()) return false;
+	links.resize((size_t)adjacencies.faceCount * 3);
+	for (uint32_t i = 0; i < adjacencies.faceCount; i++) {
+		for (int j = 0; j < 3; j++) links[(size_t)i * 3 + j] = adjacencies.faces[i].adjacentTris[j];
+	}
+	return true;
+}
\ No newline at end of file
@@ -1,9 +1,36 @@
 #ifndef SRC_STRIPERNEW_STRIPS_H_
 #define SRC_STRIPERNEW_STRIPS_H_
 
-#include <fbxsdk.h>
-#include <model/MeshObject.h>
+#include <vector>
+#include <meshstriper/StripBackend.h>
 
-void striper3(FbxMesh* inMesh, MeshObject* outMesh);
+/// <summary>
+/// <para/>Runs the Striper on a MeshObject, so it can be used as a strip backend.
+/// <para/>Kept apart from Stdafx.h, whose AdjTriangle would clash with the one in meshstriper/MeshStriper.h.
+/// </summary>
+class StriperBackend : public StripBackend {
+private:
+	StripOptions options;
+public:
+	const char* getName() const override { return "striper"; }
+	void setOptions(const StripOptions& options) override;
+
+	/// <summary>
+	/// <para/>Converts the triangle list of a mesh into an array of triangle strips, using SGI ordering (least connected faces first) unless options.leastConnectedFirst is off.
+	/// <para/>Fails on non-manifold meshes, where an edge is shared by more than 2 triangles.
+	/// </summary>
+	/// <param name="mesh">- mesh with a triangle list, to put triangle strips into</param>
+	/// <returns>False if the adjacencies couldn't be built</returns>
+	bool striper(MeshObject* mesh) override;
+
+	/// <summary>
+	/// Link the faces of a triangle list the way the Striper does before striping, for benchmarking its adjacency builder.
+	/// </summary>
+	/// <param name="triangleList">- 3 vertex indices per face</param>
+	/// <param name="threadCount">- threads the edges are linked on, for meshes with at least Adjacencies::parallelEdgeCount edges</param>
+	/// <param name="links">- 3 per face: the adjacent face, with its edge number in the 2 most significant bits, or 0xFFFFFFFF for none</param>
+	/// <returns>False if an edge is shared by more than 2 faces</returns>
+	static bool linkFaces(const std::vector<uint32_t>& triangleList, int threadCount, std::vector<uint32_t>& links);
+};
 
 #endif
\ No newline at end of file
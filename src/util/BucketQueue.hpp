@@ -0,0 +1,112 @@
+#ifndef SRC_UTIL_BUCKETQUEUE_HPP_
+#define SRC_UTIL_BUCKETQUEUE_HPP_
+
+#include <vector>
+
+/// <summary>
+/// <para/>Priority queue for items 0 to itemCount - 1 with small keys 0 to maxKey, such as the number of unused neighbours of a triangle.
+/// <para/>Every key has a doubly linked list of items, so pushing, removing and changing the key of an item are O(1).
+/// Popping the item with the smallest key scans at most maxKey + 1 lists.
+/// <para/>Items with the same key come out in the reverse order they were pushed or moved to that key.
+/// </summary>
+class BucketQueue {
+private:
+	std::vector<int> heads; // first item with each key, -1 if there is none
+	std::vector<int> next;
+	std::vector<int> previous;
+	std::vector<int> keys; // key of each item, -1 when it isn't queued
+	int minKey = 0; // no queued item has a smaller key
+	size_t count = 0;
+
+	void link(int item, int key)
+	{
+		keys[item] = key;
+		previous[item] = -1;
+		next[item] = heads[key];
+		if (heads[key] != -1) previous[heads[key]] = item;
+		heads[key] = item;
+		if (key < minKey) minKey = key;
+	}
+
+	void unlink(int item)
+	{
+		int key = keys[item];
+		if (previous[item] != -1) next[previous[item]] = next[item];
+		else heads[key] = next[item];
+		if (next[item] != -1) previous[next[item]] = previous[item];
+		keys[item] = -1;
+	}
+public:
+	/// <summary>
+	/// Empty the queue, and make room for itemCount items with keys up to maxKey.
+	/// </summary>
+	void reset(int itemCount, int maxKey)
+	{
+		heads.assign(maxKey + 1, -1);
+		next.assign(itemCount, -1);
+		previous.assign(itemCount, -1);
+		keys.assign(itemCount, -1);
+		minKey = maxKey + 1;
+		count = 0;
+	}
+
+	bool contains(int item) const { return keys[item] != -1; }
+	bool empty() const { return count == 0; }
+	size_t size() const { return count; }
+	int key(int item) const { return keys[item]; }
+
+	/// <summary>
+	/// Add an item that isn't queued yet.
+	/// </summary>
+	void push(int item, int key)
+	{
+		link(item, key);
+		count++;
+	}
+
+	/// <summary>
+	/// Remove a queued item.
+	/// </summary>
+	void remove(int item)
+	{
+		unlink(item);
+		count--;
+	}
+
+	/// <summary>
+	/// Move a queued item to another key.
+	/// </summary>
+	void changeKey(int item, int key)
+	{
+		unlink(item);
+		link(item, key);
+	}
+
+	/// <summary>
+	/// Remove and return the item with the smallest key.
+	/// </summary>
+	/// <returns>The item, or -1 if the queue is empty</returns>
+	int popMin()
+	{
+		if (count == 0) return -1;
+		while (heads[minKey] == -1) minKey++;
+		int item = heads[minKey];
+		remove(item);
+		return item;
+	}
+
+	/// <summary>
+	/// The items popMin would return next if the queue didn't change, without removing them.
+	/// </summary>
+	/// <param name="items">- filled with up to maxCount items, smallest key first</param>
+	/// <param name="maxCount">- most items to return</param>
+	void peekMin(std::vector<int>& items, size_t maxCount) const
+	{
+		items.clear();
+		for (int key = minKey; key < (int)heads.size() && items.size() < maxCount; key++) {
+			for (int item = heads[key]; item != -1 && items.size() < maxCount; item = next[item]) items.push_back(item);
+		}
+	}
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef SRC_UTIL_CPUFEATURES_HPP_
+#define SRC_UTIL_CPUFEATURES_HPP_
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define CPU_TARGET(features)
+#else
+#include <cpuid.h>
+#define CPU_TARGET(features) __attribute__((target(features)))
+#endif
+
+/// <summary>
+/// <para/>Runtime detection of the instruction sets used by the vectorized kernels.
+/// <para/>Kernels are compiled for their instruction set with CPU_TARGET, and only called when the matching check returns true.
+/// </summary>
+class CpuFeatures {
+private:
+	static void cpuid(int leaf, int subleaf, int registers[4])
+	{
+#if defined(_MSC_VER)
+		__cpuidex(registers, leaf, subleaf);
+#else
+		unsigned int a, b, c, d;
+		__cpuid_count(leaf, subleaf, a, b, c, d);
+		registers[0] = (int)a;
+		registers[1] = (int)b;
+		registers[2] = (int)c;
+		registers[3] = (int)d;
+#endif
+	}
+
+	static bool osSavesYmm()
+	{
+		int registers[4];
+		cpuid(1, 0, registers);
+		if (!(registers[2] & (1 << 27))) return false; // OSXSAVE
+#if defined(_MSC_VER)
+		unsigned long long xcr0 = _xgetbv(0);
+#else
+		unsigned int eax, edx;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		unsigned long long xcr0 = ((unsigned long long)edx << 32) | eax;
+#endif
+		return (xcr0 & 0x6) == 0x6; // xmm and ymm state
+	}
+
+public:
+	static bool hasSSE41()
+	{
+		static const bool supported = []() {
+			int registers[4];
+			cpuid(1, 0, registers);
+			return (registers[2] & (1 << 19)) != 0;
+		}();
+		return supported;
+	}
+
+	static bool hasAVX2()
+	{
+		static const bool supported = []() {
+			int registers[4];
+			cpuid(0, 0, registers);
+			if (registers[0] < 7) return false;
+			cpuid(7, 0, registers);
+			return (registers[1] & (1 << 5)) != 0 && osSavesYmm();
+		}();
+		return supported;
+	}
+};
+
+#endif
\ No newline at end of file
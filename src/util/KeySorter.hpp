@@ -0,0 +1,305 @@
+#ifndef SRC_UTIL_KEYSORTER_HPP_
+#define SRC_UTIL_KEYSORTER_HPP_
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <util/Parallel.hpp>
+
+/// <summary>
+/// Maps a key to an unsigned integer with the same order, and back, for KeySorter.
+/// </summary>
+template <typename KeyType>
+struct RadixKey {
+	typedef KeyType Type;
+	static Type toRadix(KeyType key) { return key; }
+	static KeyType fromRadix(Type radix) { return radix; }
+};
+
+/// <summary>
+/// Floats sort by their bits once negative floats have every bit flipped, and positive floats their sign bit.
+/// </summary>
+template <>
+struct RadixKey<float> {
+	typedef uint32_t Type;
+	static Type toRadix(float key)
+	{
+		uint32_t bits;
+		memcpy(&bits, &key, sizeof(bits));
+		return (bits & 0x80000000) ? ~bits : bits | 0x80000000;
+	}
+	static float fromRadix(Type radix)
+	{
+		uint32_t bits = (radix & 0x80000000) ? radix & 0x7FFFFFFF : ~radix;
+		float key;
+		memcpy(&key, &bits, sizeof(key));
+		return key;
+	}
+};
+
+/// <summary>
+/// <para/>Stable LSD radix sort of keys with an int value each, RadixBits per pass, for uint16_t, uint32_t, uint64_t or float keys.
+/// <para/>All digit histograms are counted in one read of the keys, passes where every key has the same digit are skipped, the first
+/// pass reads straight from the input, the passes ping-pong between the workspace buffers, and the last one writes into the output.
+/// <para/>Large inputs can be split over threads: every thread counts the digits of its chunk, a parallel prefix sum turns the counts
+/// into offsets that run through the buckets, and through the chunks within a bucket, and every thread scatters its chunk from its own
+/// offsets. The result is the same as sorting on one thread.
+/// <para/>The workspace belongs to the caller and keeps its buffers, so once it has grown to the largest input and thread count,
+/// sorting with it allocates nothing.
+/// </summary>
+template <typename KeyType, int RadixBits = 11>
+class KeySorter {
+	static_assert(RadixBits >= 4 && RadixBits <= 16, "digits must have 4 to 16 bits");
+public:
+	typedef typename RadixKey<KeyType>::Type RadixType;
+	static const int bucketCount = 1 << RadixBits;
+	static const int passCount = ((int)sizeof(RadixType) * 8 + RadixBits - 1) / RadixBits;
+	static const size_t parallelGrain = 1 << 15; // fewest keys per thread worth starting a thread for
+
+	/// <summary>
+	/// A key and its value, kept together so a pass scatters them with one write.
+	/// </summary>
+	struct Item {
+		RadixType key;
+		int value;
+	};
+
+	/// <summary>
+	/// Buffers kept between sorts.
+	/// </summary>
+	struct Workspace {
+		std::vector<Item> items[2]; // pairs between the passes of sortPairs
+		std::vector<int> indices[2]; // indices between the passes of sortIndices
+		std::vector<int> counts; // digit histograms of every pass for every thread chunk, turned into offsets pass by pass
+		std::vector<int> rangeSums; // keys in each range of buckets of the prefix sum, then where the range starts
+
+		size_t memoryUsage() const
+		{
+			return (items[0].capacity() + items[1].capacity()) * sizeof(Item)
+				+ (indices[0].capacity() + indices[1].capacity() + counts.capacity() + rangeSums.capacity()) * sizeof(int);
+		}
+	};
+
+	/// <summary>
+	/// Sort keys in place, moving the value of each key with it. Equal keys keep the order of their values.
+	/// </summary>
+	/// <param name="keys">- keys to sort</param>
+	/// <param name="values">- value of each key</param>
+	/// <param name="workspace">- buffers to sort in</param>
+	/// <param name="threadCount">- most threads to sort with, inputs below parallelGrain keys per thread use fewer</param>
+	static void sortPairs(std::vector<KeyType>& keys, std::vector<int>& values, Workspace& workspace, int threadCount = 1)
+	{
+		sort<false>(keys.data(), values.data(), keys.data(), values.data(), keys.size(), workspace, threadCount);
+	}
+
+	/// <summary>
+	/// Stable order of keys, like Sorter::sortFast: sortedIndices[i] is the index of the i-th smallest key.
+	/// </summary>
+	/// <param name="keys">- keys to sort by, left as they are</param>
+	/// <param name="sortedIndices">- indices into keys, in sorted order</param>
+	/// <param name="workspace">- buffers to sort in</param>
+	/// <param name="threadCount">- most threads to sort with, inputs below parallelGrain keys per thread use fewer</param>
+	static void sortIndices(const std::vector<KeyType>& keys, std::vector<int>& sortedIndices, Workspace& workspace, int threadCount = 1)
+	{
+		sortedIndices.resize(keys.size());
+		sort<true>(keys.data(), nullptr, nullptr, sortedIndices.data(), keys.size(), workspace, threadCount);
+	}
+
+	/// <summary>
+	/// Stable order of the indices in inputIndices by their keys, for multi sorting: sorting by a second key in the order of a sort by
+	/// the first key sorts by both.
+	/// </summary>
+	/// <param name="keys">- keys to sort by, left as they are</param>
+	/// <param name="inputIndices">- every index into keys once, in the order equal keys should keep</param>
+	/// <param name="sortedIndices">- inputIndices in sorted order</param>
+	/// <param name="workspace">- buffers to sort in</param>
+	/// <param name="threadCount">- most threads to sort with, inputs below parallelGrain keys per thread use fewer</param>
+	static void sortIndices(const std::vector<KeyType>& keys, const std::vector<int>& inputIndices, std::vector<int>& sortedIndices, Workspace& workspace, int threadCount = 1)
+	{
+		sortedIndices.resize(inputIndices.size());
+		sort<true>(keys.data(), inputIndices.data(), nullptr, sortedIndices.data(), inputIndices.size(), workspace, threadCount);
+	}
+
+private:
+	static RadixType digit(RadixType radix, int pass)
+	{
+		return (radix >> (pass * RadixBits)) & (RadixType)(bucketCount - 1);
+	}
+
+	/// <summary>
+	/// <para/>Turn the digit counts of every thread chunk into the offsets the chunks scatter from, bucket major and thread minor,
+	/// so the sort stays stable.
+	/// <para/>Every thread sums a range of buckets, the range totals are scanned, and every thread then writes the offsets of its range.
+	/// </summary>
+	/// <param name="counts">- counts of the first chunk, overwritten with offsets</param>
+	/// <param name="stride">- distance between the counts of consecutive chunks</param>
+	/// <param name="threadCount">- number of chunks, and threads to sum with</param>
+	/// <param name="workspace">- workspace holding the range sums</param>
+	static void bucketOffsets(int* counts, size_t stride, int threadCount, Workspace& workspace)
+	{
+		workspace.rangeSums.assign(threadCount + 1, 0);
+		int* rangeSums = workspace.rangeSums.data();
+		Parallel::forRange(bucketCount, threadCount, [&](size_t begin, size_t end, int range) {
+			int sum = 0;
+			for (size_t bucket = begin; bucket < end; bucket++) {
+				for (int thread = 0; thread < threadCount; thread++) sum += counts[stride * thread + bucket];
+			}
+			rangeSums[range + 1] = sum;
+		}, Parallel::itemGrain);
+		for (int range = 0; range < threadCount; range++) rangeSums[range + 1] += rangeSums[range];
+		Parallel::forRange(bucketCount, threadCount, [&](size_t begin, size_t end, int range) {
+			int offset = rangeSums[range];
+			for (size_t bucket = begin; bucket < end; bucket++) {
+				for (int thread = 0; thread < threadCount; thread++) {
+					int& bucketCounts = counts[stride * thread + bucket];
+					int chunkCount = bucketCounts;
+					bucketCounts = offset;
+					offset += chunkCount;
+				}
+			}
+		}, Parallel::itemGrain);
+	}
+
+	/// <summary>
+	/// Scatter items begin to end - 1 to the offsets of their digits, read(i, radix, value) reads item i and write(position, radix, value) stores it.
+	/// </summary>
+	template <typename Read, typename Write>
+	static void scatter(size_t begin, size_t end, int* offsets, int pass, Read read, Write write)
+	{
+		for (size_t i = begin; i < end; i++) {
+			RadixType radix;
+			int value;
+			read(i, radix, value);
+			write(offsets[(int)digit(radix, pass)]++, radix, value);
+		}
+	}
+
+	/// <summary>
+	/// <para/>Sort count pairs from (keys, values) into (outKeys, outValues), which may be the same arrays.
+	/// <para/>IndexedKeys means the values index the keys, so the key of value v is keys[v] rather than the key next to it. Then only
+	/// the values move, and every pass reads the key of a value through it, as moving 16 bit keys along costs more than looking them up.
+	/// </summary>
+	/// <param name="keys">- keys to sort</param>
+	/// <param name="values">- value of each key, nullptr for 0, 1, 2...</param>
+	/// <param name="outKeys">- sorted keys, nullptr when only the values are wanted. Must be nullptr for IndexedKeys.</param>
+	/// <param name="outValues">- values in sorted key order</param>
+	/// <param name="count">- number of pairs</param>
+	/// <param name="workspace">- buffers to sort in</param>
+	/// <param name="threadCount">- most threads to sort with</param>
+	template <bool IndexedKeys>
+	static void sort(const KeyType* keys, const int* values, KeyType* outKeys, int* outValues, size_t count, Workspace& workspace, int threadCount)
+	{
+		threadCount = std::max(1, std::min(threadCount, (int)(count / parallelGrain)));
+		const size_t histogramSize = (size_t)passCount * bucketCount; // counts of one chunk
+		auto readInput = [&](size_t i, RadixType& radix, int& value) {
+			value = values ? values[i] : (int)i;
+			radix = RadixKey<KeyType>::toRadix(keys[IndexedKeys ? (size_t)value : i]);
+		};
+		workspace.counts.assign(histogramSize * threadCount, 0);
+		int* counts = workspace.counts.data();
+		// indexed keys are a permutation of the keys, and a single chunk counts the same digits in any order, so it reads them as they lie
+		bool countInOrder = IndexedKeys && threadCount == 1;
+		Parallel::forRange(count, threadCount, [&](size_t begin, size_t end, int thread) {
+			int* chunkCounts = counts + histogramSize * thread;
+			for (size_t i = begin; i < end; i++) {
+				RadixType radix = RadixKey<KeyType>::toRadix(keys[IndexedKeys && !countInOrder && values ? (size_t)values[i] : i]);
+				for (int pass = 0; pass < passCount; pass++) chunkCounts[pass * bucketCount + (int)digit(radix, pass)]++;
+			}
+		}, parallelGrain);
+
+		int passes[passCount];
+		int activeCount = 0;
+		if (count > 0) {
+			RadixType firstRadix;
+			int firstValue;
+			readInput(0, firstRadix, firstValue);
+			for (int pass = 0; pass < passCount; pass++) {
+				size_t firstDigitCount = 0;
+				for (int thread = 0; thread < threadCount; thread++) firstDigitCount += counts[histogramSize * thread + pass * bucketCount + (int)digit(firstRadix, pass)];
+				if (firstDigitCount != count) passes[activeCount++] = pass;
+			}
+		}
+		if (activeCount == 0) {
+			// already in order: the keys stay, the values are copied unless they're already in place
+			if (outValues != values) {
+				for (size_t i = 0; i < count; i++) outValues[i] = values ? values[i] : (int)i;
+			}
+			if (outKeys && outKeys != keys) std::copy(keys, keys + count, outKeys);
+			return;
+		}
+
+		// the first pass reads the input, the others ping-pong between the workspace buffers, and the last one writes the output.
+		// A single pass over an input that is also the output goes through the workspace.
+		bool inPlace = outValues == values || (outKeys && outKeys == keys);
+		if (activeCount > 1 || inPlace) {
+			// shrinking keeps the capacity, so the buffers only grow
+			for (int buffer = 0; buffer < 2; buffer++) {
+				if (IndexedKeys) workspace.indices[buffer].resize(count);
+				else workspace.items[buffer].resize(count);
+			}
+		}
+		for (int active = 0; active < activeCount; active++) {
+			int pass = passes[active];
+			int* passCounts = counts + pass * bucketCount;
+			const Item* sourceItems = workspace.items[(active + 1) & 1].data();
+			const int* sourceIndices = workspace.indices[(active + 1) & 1].data();
+			auto readWorkspace = [&](size_t i, RadixType& radix, int& value) {
+				if (IndexedKeys) {
+					value = sourceIndices[i];
+					radix = RadixKey<KeyType>::toRadix(keys[value]);
+				}
+				else {
+					radix = sourceItems[i].key;
+					value = sourceItems[i].value;
+				}
+			};
+			if (active > 0 && threadCount > 1) {
+				// the earlier passes moved the keys between the chunks, so the chunks are counted again
+				Parallel::forRange(count, threadCount, [&](size_t begin, size_t end, int thread) {
+					int* chunkCounts = passCounts + histogramSize * thread;
+					std::fill(chunkCounts, chunkCounts + bucketCount, 0);
+					for (size_t i = begin; i < end; i++) {
+						RadixType radix;
+						int value;
+						readWorkspace(i, radix, value);
+						chunkCounts[(int)digit(radix, pass)]++;
+					}
+				}, parallelGrain);
+			}
+			bucketOffsets(passCounts, histogramSize, threadCount, workspace);
+
+			Item* destinationItems = workspace.items[active & 1].data();
+			int* destinationIndices = workspace.indices[active & 1].data();
+			bool toOutput = active + 1 == activeCount && !(active == 0 && inPlace);
+			auto writeWorkspace = [&](int position, RadixType radix, int value) {
+				if (IndexedKeys) destinationIndices[position] = value;
+				else destinationItems[position] = { radix, value };
+			};
+			auto writeOutput = [&](int position, RadixType radix, int value) {
+				if (outKeys) outKeys[position] = RadixKey<KeyType>::fromRadix(radix);
+				outValues[position] = value;
+			};
+			Parallel::forRange(count, threadCount, [&](size_t begin, size_t end, int thread) {
+				int* offsets = passCounts + histogramSize * thread;
+				if (active == 0 && toOutput) scatter(begin, end, offsets, pass, readInput, writeOutput);
+				else if (active == 0) scatter(begin, end, offsets, pass, readInput, writeWorkspace);
+				else if (toOutput) scatter(begin, end, offsets, pass, readWorkspace, writeOutput);
+				else scatter(begin, end, offsets, pass, readWorkspace, writeWorkspace);
+			}, parallelGrain);
+		}
+		if (activeCount == 1 && inPlace) {
+			const Item* sortedItems = workspace.items[0].data();
+			const int* sortedIndices = workspace.indices[0].data();
+			for (size_t i = 0; i < count; i++) {
+				if (IndexedKeys) outValues[i] = sortedIndices[i];
+				else {
+					if (outKeys) outKeys[i] = RadixKey<KeyType>::fromRadix(sortedItems[i].key);
+					outValues[i] = sortedItems[i].value;
+				}
+			}
+		}
+	}
+};
+
+#endif
\ No newline at end of file
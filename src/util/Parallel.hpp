@@ -0,0 +1,58 @@
+#ifndef SRC_UTIL_PARALLEL_HPP_
+#define SRC_UTIL_PARALLEL_HPP_
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+class Parallel {
+public:
+	/// <summary>
+	/// Number of threads to use. 0 or less means one per hardware thread.
+	/// </summary>
+	static int threadCount(int requested)
+	{
+		if (requested > 0) return requested;
+		int hardwareThreads = (int)std::thread::hardware_concurrency();
+		return hardwareThreads > 0 ? hardwareThreads : 1;
+	}
+
+	/// <summary>
+	/// Fewest items per thread worth starting a thread for, when every item only takes a handful of operations.
+	/// </summary>
+	static const size_t itemGrain = 4096;
+
+	/// <summary>
+	/// <para/>Split [0, count) into up to threadCount contiguous chunks of at least grain items, and call function(begin, end, threadIndex)
+	/// for each chunk on its own thread. Thread indices stay below threadCount.
+	/// <para/>Chunks only depend on count, threadCount and grain, so results are deterministic for a fixed thread count.
+	/// <para/>The first chunk runs on the calling thread, so ranges of less than twice grain items run entirely on the calling thread.
+	/// With the default grain of 1 every item can get a thread, for ranges of few but expensive items such as partitions.
+	/// </summary>
+	/// <param name="count">- number of items</param>
+	/// <param name="threadCount">- most chunks/threads</param>
+	/// <param name="function">- void(size_t begin, size_t end, int threadIndex)</param>
+	/// <param name="grain">- fewest items per chunk, itemGrain for cheap items</param>
+	template <typename Function>
+	static void forRange(size_t count, int threadCount, Function function, size_t grain = 1)
+	{
+		size_t chunkLimit = std::min(count / std::max(grain, (size_t)1), (size_t)1 << 16);
+		threadCount = std::max(1, std::min(threadCount, (int)chunkLimit));
+		if (threadCount <= 1) {
+			function((size_t)0, count, 0);
+			return;
+		}
+		size_t chunkSize = (count + threadCount - 1) / threadCount;
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount - 1);
+		for (int t = 1; t < threadCount; t++) {
+			size_t begin = std::min(count, chunkSize * t);
+			size_t end = std::min(count, begin + chunkSize);
+			threads.emplace_back([&function, begin, end, t]() { function(begin, end, t); });
+		}
+		function((size_t)0, std::min(count, chunkSize), 0);
+		for (std::thread& thread : threads) thread.join();
+	}
+};
+
+#endif
\ No newline at end of file